@@ -0,0 +1,146 @@
+#include <sstream>
+#include "log4cxx/logger.h"
+
+#include "cql-interface/BatchBuilder.h"
+#include "cql-interface/CassConn.h"
+#include "cql-interface/Exception.h"
+
+using namespace cb;
+using namespace std;
+
+namespace {
+    log4cxx::LoggerPtr logger(log4cxx::Logger::getLogger("cb.batch_builder"));
+
+    CassBatchType to_cass_type(BATCH_TYPE_ENUM batch_type)
+    {
+        switch (batch_type)
+        {
+            case BATCH_UNLOGGED_ENUM:
+                return CASS_BATCH_TYPE_UNLOGGED;
+            case BATCH_COUNTER_ENUM:
+                return CASS_BATCH_TYPE_COUNTER;
+            case BATCH_LOGGED_ENUM:
+                break;
+        }
+        return CASS_BATCH_TYPE_LOGGED;
+    }
+}
+
+BatchBuilder::BatchBuilder(BATCH_TYPE_ENUM batch_type, 
+                           size_t max_bytes)
+: m_batch_type(batch_type),
+  m_max_bytes(max_bytes),
+  m_has_consist(false),
+  m_consist(CASS_CONSISTENCY_LOCAL_QUORUM),
+  m_timeout_in_micro(0),
+  m_batch(0),
+  m_num_statements(0),
+  m_num_bytes(0)
+{
+}
+
+BatchBuilder::BatchBuilder(BATCH_TYPE_ENUM batch_type, 
+                           size_t max_bytes,
+                           CassConsistency consist,
+                           cass_duration_t timeout_in_micro)
+: m_batch_type(batch_type),
+  m_max_bytes(max_bytes),
+  m_has_consist(true),
+  m_consist(consist),
+  m_timeout_in_micro(timeout_in_micro),
+  m_batch(0),
+  m_num_statements(0),
+  m_num_bytes(0)
+{
+}
+
+BatchBuilder::~BatchBuilder()
+{
+    clear();
+}
+
+void BatchBuilder::clear()
+{
+    if (m_batch)
+    {
+        cass_batch_free(m_batch);
+        m_batch = 0;
+    }
+    m_num_statements = 0;
+    m_num_bytes = 0;
+}
+
+bool BatchBuilder::add(const std::string& query)
+{
+    size_t num_bytes = statement_overhead + query.size();
+    if (!has_room(num_bytes))
+    {
+        return false;
+    }
+    return add_statement(cass_statement_new(cass_string_init(query.c_str()), 0), num_bytes);
+}
+
+bool BatchBuilder::add_statement(CassStatement* statement, size_t num_bytes)
+{
+    if (!statement)
+    {
+        LOG4CXX_ERROR(logger, "BatchBuilder::add getting null statement");
+        return false;
+    }
+    if (!m_batch)
+    {
+        m_batch = cass_batch_new(to_cass_type(m_batch_type));
+        if (!m_batch)
+        {
+            cass_statement_free(statement);
+            throw Exception("failed creating cassandra batch", __FILE__, __LINE__);
+        }
+    }
+    // the batch keeps its own reference to the statement
+    CassError rc = cass_batch_add_statement(m_batch, statement);
+    cass_statement_free(statement);
+    if (rc != CASS_OK)
+    {
+        LOG4CXX_ERROR(logger, "BatchBuilder::add failed: " << cass_error_desc(rc));
+        return false;
+    }
+    ++m_num_statements;
+    m_num_bytes += num_bytes;
+    return true;
+}
+
+std::string BatchBuilder::description() const
+{
+    ostringstream desc;
+    desc << "batch of " << m_num_statements << " statements, about " << m_num_bytes << " bytes";
+    return desc.str();
+}
+
+CassBatch* BatchBuilder::release()
+{
+    CassBatch* batch = m_batch;
+    m_batch = 0;
+    m_num_statements = 0;
+    m_num_bytes = 0;
+    return batch;
+}
+
+bool BatchBuilder::execute()
+{
+    if (empty())
+    {
+        return true;
+    }
+    return CassConn::store(*this);
+}
+
+bool BatchBuilder::async_execute(StoreHolderPtr store_holder)
+{
+    if (empty() && store_holder)
+    {
+        // nothing to send, same as execute
+        store_holder->set_result(true);
+        return true;
+    }
+    return CassConn::async_store(*this, store_holder);
+}
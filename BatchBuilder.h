@@ -0,0 +1,129 @@
+#ifndef CB_BATCH_BUILDER_H
+#define CB_BATCH_BUILDER_H
+
+#include <string>
+#include <cassandra.h>
+#include "cql-interface/PreparedStore.h"
+#include "cql-interface/StoreHolder.h"
+
+namespace cb {
+
+    // BATCH_LOGGED_ENUM: goes through the batch log, all or nothing (default)
+    // BATCH_UNLOGGED_ENUM: no batch log. Best for rows in the same partition.
+    // BATCH_COUNTER_ENUM: counter updates only
+    enum BATCH_TYPE_ENUM { BATCH_LOGGED_ENUM, BATCH_UNLOGGED_ENUM, BATCH_COUNTER_ENUM };
+
+    // collects text and prepared stores and sends them as one CassBatch.
+    // add returns false once the next statement would go over max_bytes, so
+    // execute and add again. The byte count is an estimate of the bound values,
+    // keep max_bytes under the server batch_size_fail_threshold_in_kb.
+    // Not thread safe, use one per thread.
+    class BatchBuilder
+    {
+    public:
+
+        static const size_t def_max_bytes = 50 * 1024;   // server default fail threshold
+
+        // uses the CassConn default consistency and timeout
+        explicit BatchBuilder(BATCH_TYPE_ENUM batch_type = BATCH_LOGGED_ENUM, 
+                              size_t max_bytes = def_max_bytes);
+        BatchBuilder(BATCH_TYPE_ENUM batch_type, 
+                     size_t max_bytes,
+                     CassConsistency consist,
+                     cass_duration_t timeout_in_micro = 0);
+
+        ~BatchBuilder();
+
+        // text query, no bind markers
+        bool add(const std::string& query);
+
+        // binds the same as PreparedStore::store, will throw if there is an issue binding values.
+        template<typename... Targs>
+        bool add(PreparedStore& prep_store, const Targs&... Fargs)
+        {
+            prep_store.check_num_args(sizeof...(Fargs), "BatchBuilder::add");
+
+            size_t num_bytes = statement_overhead + PreparedStore::bound_size(Fargs...);
+            if (!has_room(num_bytes))
+            {
+                return false;
+            }
+            return add_statement(prep_store.new_statement(Fargs...), num_bytes);
+        }
+
+        // sends the batch and waits for it. Counts as one call in the stored stats.
+        // The builder is empty afterwards, whether or not it worked.
+        // An empty batch sends nothing and returns true.
+        bool execute();
+
+        // same, but the store_holder picks up the result.
+        // An empty batch sends nothing and leaves store_holder done with true.
+        bool async_execute(StoreHolderPtr store_holder);
+
+        // drops anything added so far
+        void clear();
+
+        // number of statements added
+        size_t size() const
+        {
+            return m_num_statements;
+        }
+
+        bool empty() const
+        {
+            return m_num_statements == 0;
+        }
+
+        // estimated size of the statements added
+        size_t num_bytes() const
+        {
+            return m_num_bytes;
+        }
+
+        size_t max_bytes() const
+        {
+            return m_max_bytes;
+        }
+
+        BATCH_TYPE_ENUM batch_type() const
+        {
+            return m_batch_type;
+        }
+
+    private:
+
+        BatchBuilder(const BatchBuilder&) = delete;
+        BatchBuilder& operator=(const BatchBuilder&) = delete;
+
+        // rough per statement framing: kind, id or query length, value count
+        static const size_t statement_overhead = 24;
+
+        // an empty batch always takes the first statement, even if it is too big
+        bool has_room(size_t num_bytes) const
+        {
+            return !m_num_statements || m_num_bytes + num_bytes <= m_max_bytes;
+        }
+
+        // takes ownership of statement
+        bool add_statement(CassStatement* statement, size_t num_bytes);
+
+        // describes the batch in log messages
+        std::string description() const;
+
+        friend class CassConn;
+        CassBatch* release();
+
+        BATCH_TYPE_ENUM m_batch_type;
+        size_t m_max_bytes;
+        bool m_has_consist;
+        CassConsistency m_consist;
+        cass_duration_t m_timeout_in_micro;
+
+        CassBatch* m_batch;
+        size_t m_num_statements;
+        size_t m_num_bytes;
+    };
+}
+
+#endif 
+
@@ -0,0 +1,160 @@
+#include "log4cxx/logger.h"
+
+#include "cql-interface/BulkWriter.h"
+#include "cql-interface/CassConn.h"
+#include "cql-interface/Exception.h"
+
+using namespace cb;
+using namespace std;
+
+namespace {
+    log4cxx::LoggerPtr logger(log4cxx::Logger::getLogger("cb.bulk_writer"));
+}
+
+BulkWriter::BulkWriter(PreparedStorePtr prep_store, 
+                       double queue_fraction,
+                       unsigned max_retries,
+                       bool idempotent)
+: m_prep_store(prep_store),
+  m_window(1),
+  m_max_retries(max_retries),
+  m_idempotent(idempotent),
+  m_generation(0),
+  m_ok(true)
+{
+    if (!m_prep_store)
+    {
+        throw Exception("can't make BulkWriter with null PreparedStorePtr", __FILE__, __LINE__);
+    }
+    unsigned queue_size_io = CassConn::get_queue_size_io();
+    double window = queue_fraction * queue_size_io;
+    if (window >= queue_size_io)
+    {
+        m_window = queue_size_io;
+    } else if (window > 1)
+    {
+        m_window = unsigned(window);
+    }
+}
+
+BulkWriter::~BulkWriter()
+{
+    flush();
+}
+
+void BulkWriter::send(Binder binder, unsigned attempts)
+{
+    Pending pending;
+    pending.m_binder = binder;
+    pending.m_holder.reset(new StoreHolder());
+    pending.m_attempts = attempts + 1;
+    pending.m_generation = m_generation;
+
+    // the driver holds on to what it needs once executed
+    CassStatement* statement = binder();
+    if (!CassConn::async_store(*m_prep_store, statement, pending.m_holder))
+    {
+        // StoreHolder was cleared, so wait() reports the failure when reaped
+        LOG4CXX_DEBUG(logger, "BulkWriter could not send store: " << m_prep_store->query());
+    }
+    cass_statement_free(statement);
+    m_pending.push_back(pending);
+}
+
+bool BulkWriter::can_retry(Pending& pending)
+{
+    if (pending.m_holder->was_unprepared())
+    {
+        // a whole window can fail like this at once, only prepare again for
+        // the ones sent before the last reprepare
+        if (pending.m_generation == m_generation)
+        {
+            if (!m_prep_store->reprepare())
+            {
+                LOG4CXX_ERROR(logger, "BulkWriter could not prepare again: " << m_prep_store->query());
+                return false;
+            }
+            ++m_generation;
+        }
+        return true;
+    }
+    if (pending.m_holder->timed_out())
+    {
+        return m_idempotent;
+    }
+    switch (pending.m_holder->error_code())
+    {
+        // the server did not apply these
+        case CASS_ERROR_SERVER_UNAVAILABLE:
+        case CASS_ERROR_SERVER_OVERLOADED:
+        case CASS_ERROR_SERVER_IS_BOOTSTRAPPING:
+        case CASS_ERROR_LIB_NO_HOSTS_AVAILABLE:
+        case CASS_ERROR_LIB_REQUEST_QUEUE_FULL:
+            return true;
+
+        // these may have been applied
+        case CASS_ERROR_SERVER_WRITE_TIMEOUT:
+            return m_idempotent;
+
+        default:
+            return false;
+    }
+}
+
+bool BulkWriter::reap(Pending& pending)
+{
+    bool retVal = pending.m_holder->wait();
+    if (retVal)
+    {
+        ++m_summary.m_written;
+    } else if (pending.m_attempts <= m_max_retries && can_retry(pending))
+    {
+        // bound again, from the current prepared, back in the window
+        ++m_summary.m_retried;
+        send(pending.m_binder, pending.m_attempts);
+        return true;
+    } else
+    {
+        ++m_summary.m_failed;
+        m_ok = false;
+        LOG4CXX_ERROR(logger, "BulkWriter store failed after " << pending.m_attempts 
+                                << " attempts: " << m_prep_store->query());
+    }
+    return retVal;
+}
+
+bool BulkWriter::make_room()
+{
+    bool retVal = true;
+
+    // reap what is done already. Checks from the oldest and stops at the first
+    // one still running, so this stays cheap with a big window.
+    while (!m_pending.empty() && m_pending.front().m_holder->is_ready())
+    {
+        Pending pending = m_pending.front();
+        m_pending.pop_front();
+        retVal = reap(pending) && retVal;
+    }
+
+    // still full, so wait on the oldest
+    while (m_pending.size() >= m_window)
+    {
+        Pending pending = m_pending.front();
+        m_pending.pop_front();
+        retVal = reap(pending) && retVal;
+    }
+    return retVal;
+}
+
+bool BulkWriter::flush()
+{
+    while (!m_pending.empty())
+    {
+        Pending pending = m_pending.front();
+        m_pending.pop_front();
+        reap(pending);
+    }
+    bool retVal = m_ok;
+    m_ok = true;
+    return retVal;
+}
@@ -0,0 +1,314 @@
+#ifndef CB_BULK_WRITER_H
+#define CB_BULK_WRITER_H
+
+#include <deque>
+#include <functional>
+#include <iterator>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "cql-interface/PreparedStore.h"
+#include "cql-interface/StoreHolder.h"
+
+namespace cb {
+
+    namespace bulk_writer_detail {
+
+        // a list or set kept from a CollectionRange
+        template<typename T>
+        struct OwnedCollection
+        {
+            CassCollectionType m_type;
+            std::vector<T> m_values;
+        };
+
+        // a map kept from a MapRange
+        template<typename K, typename V>
+        struct OwnedMap
+        {
+            std::vector<std::pair<K, V>> m_pairs;
+        };
+
+        // bind sources which only point at the caller's data
+        template<typename T> struct IsView : std::false_type {};
+        template<> struct IsView<const char*> : std::true_type {};
+        template<> struct IsView<char*> : std::true_type {};
+        template<> struct IsView<CassString> : std::true_type {};
+        template<> struct IsView<CassBytes> : std::true_type {};
+        template<> struct IsView<const CassCollection*> : std::true_type {};
+        template<> struct IsView<CassCollection*> : std::true_type {};
+#if __cplusplus >= 201703L
+        template<> struct IsView<std::string_view> : std::true_type {};
+#endif
+        template<typename It> struct IsView<CollectionRange<It>> : std::true_type {};
+        template<typename It> struct IsView<MapRange<It>> : std::true_type {};
+        template<typename K, typename V> struct IsView<std::pair<K, V>> 
+            : std::integral_constant<bool, IsView<typename std::remove_const<K>::type>::value 
+                                            || IsView<V>::value> {};
+
+        // true if the elements of a std container are views
+        template<typename T>
+        auto has_view_items(int) -> IsView<typename T::value_type>;
+        template<typename T>
+        std::false_type has_view_items(long);
+
+        // how write keeps a value until its store is done for good. Views are
+        // copied into a type which owns its data, everything else is kept as is.
+        template<typename T>
+        struct Owned
+        {
+            static_assert(!decltype(has_view_items<T>(0))::value,
+                          "BulkWriter::write can't keep containers of views, use std::string or CassBytesMgr items");
+            static_assert(!IsView<T>::value,
+                          "BulkWriter::write can't keep a CassCollection, bind a std container instead");
+            typedef T type;
+            static const T& own(const T& val)
+            {
+                return val;
+            }
+        };
+
+        template<>
+        struct Owned<const char*>
+        {
+            typedef std::string type;
+            static type own(const char* val)
+            {
+                return val ? type(val) : type();
+            }
+        };
+
+        template<>
+        struct Owned<char*> : Owned<const char*>
+        {
+        };
+
+        template<size_t N>
+        struct Owned<char[N]>
+        {
+            typedef std::string type;
+            static type own(const char* val)
+            {
+                return type(val);
+            }
+        };
+
+        template<>
+        struct Owned<CassString>
+        {
+            typedef std::string type;
+            static type own(const CassString& val)
+            {
+                return type(val.data, val.length);
+            }
+        };
+
+#if __cplusplus >= 201703L
+        template<>
+        struct Owned<std::string_view>
+        {
+            typedef std::string type;
+            static type own(const std::string_view& val)
+            {
+                return type(val);
+            }
+        };
+#endif
+
+        template<>
+        struct Owned<CassBytes>
+        {
+            typedef CassBytesMgr type;
+            static type own(const CassBytes& val)
+            {
+                return type(CassBytesMgr::Bytes(val.data, val.data + val.size));
+            }
+        };
+
+        template<typename It>
+        struct Owned<CollectionRange<It>>
+        {
+            typedef typename std::iterator_traits<It>::value_type Item;
+            typedef OwnedCollection<typename Owned<Item>::type> type;
+            static type own(const CollectionRange<It>& val)
+            {
+                type retVal;
+                retVal.m_type = val.m_type;
+                retVal.m_values.reserve(val.m_size);
+                for (It it = val.m_begin; it != val.m_end; ++it)
+                {
+                    retVal.m_values.push_back(Owned<Item>::own(*it));
+                }
+                return retVal;
+            }
+        };
+
+        template<typename It>
+        struct Owned<MapRange<It>>
+        {
+            typedef typename std::iterator_traits<It>::value_type Pair;
+            typedef typename std::remove_const<typename Pair::first_type>::type Key;
+            typedef typename Pair::second_type Value;
+            typedef OwnedMap<typename Owned<Key>::type, typename Owned<Value>::type> type;
+            static type own(const MapRange<It>& val)
+            {
+                type retVal;
+                retVal.m_pairs.reserve(val.m_size);
+                for (It it = val.m_begin; it != val.m_end; ++it)
+                {
+                    retVal.m_pairs.push_back(std::make_pair(Owned<Key>::own(it->first), 
+                                                            Owned<Value>::own(it->second)));
+                }
+                return retVal;
+            }
+        };
+
+        // what a kept value is bound as
+        template<typename T>
+        const T& as_bound(const T& val)
+        {
+            return val;
+        }
+
+        template<typename T>
+        CollectionRange<typename std::vector<T>::const_iterator> as_bound(const OwnedCollection<T>& val)
+        {
+            return CollectionRange<typename std::vector<T>::const_iterator>{ 
+                        val.m_type, val.m_values.begin(), val.m_values.end(), val.m_values.size() };
+        }
+
+        template<typename K, typename V>
+        MapRange<typename std::vector<std::pair<K, V>>::const_iterator> as_bound(const OwnedMap<K, V>& val)
+        {
+            return as_map(val.m_pairs.begin(), val.m_pairs.end());
+        }
+    }
+
+    // pipelines many writes through one PreparedStore, keeping up to window
+    // stores in flight instead of waiting on each one. Completed stores are
+    // reaped as write is called. Ones the server surely did not apply (unavailable,
+    // overloaded, no hosts, unprepared) are sent again up to max_retries, and
+    // timed out ones too if idempotent. Pass idempotent false for counter updates,
+    // which would count twice.
+    // The window is a fraction of CassConn::get_queue_size_io so the driver
+    // pending queue is not overrun, even with a few writers at once.
+    //
+    //     BulkWriter writer(prep_store);
+    //     for (...) writer.write(docid, value);
+    //     writer.flush();
+    //     writer.summary().m_failed == 0;
+    //
+    // Not thread safe, use one per thread.
+    class BulkWriter
+    {
+    public:
+
+        struct Summary
+        {
+            uint64_t m_written = 0;  // stores that worked
+            uint64_t m_failed = 0;   // stores that failed after all retries
+            uint64_t m_retried = 0;  // number of times a store was sent again
+        };
+
+        // queue_fraction of CassConn::get_queue_size_io is the window, at least 1.
+        BulkWriter(PreparedStorePtr prep_store, 
+                   double queue_fraction = 0.5,
+                   unsigned max_retries = 2,
+                   bool idempotent = true);
+
+        // waits for anything still in flight
+        ~BulkWriter();
+
+        // queues a store, waiting for room in the window if needed.
+        // Binds the same as PreparedStore::store, will throw if there is an issue binding values.
+        // Returns false if a store failed for good while making room.
+        //
+        // Unlike PreparedStore::async_store, the values are kept until the store
+        // is done for good, since a retry binds them again after write returns.
+        // So views (as_text, as_bytes, as_list, as_set, as_map, const char*,
+        // string_view, CassString, CassBytes) are copied into std::string,
+        // CassBytesMgr or a vector first. A CassCollection, or a std container
+        // of views, does not compile.
+        template<typename... Targs>
+        bool write(const Targs&... Fargs)
+        {
+            m_prep_store->check_num_args(sizeof...(Fargs), "BulkWriter::write");
+
+            bool retVal = make_room();
+            send(make_binder(m_prep_store, bulk_writer_detail::Owned<Targs>::own(Fargs)...));
+            return retVal;
+        }
+
+        // waits for everything in flight, returns true if none failed since the last flush
+        bool flush();
+
+        // totals since this was made
+        const Summary& summary() const
+        {
+            return m_summary;
+        }
+
+        unsigned window() const
+        {
+            return m_window;
+        }
+
+        size_t in_flight() const
+        {
+            return m_pending.size();
+        }
+
+    private:
+
+        BulkWriter(const BulkWriter&) = delete;
+        BulkWriter& operator=(const BulkWriter&) = delete;
+
+        typedef std::function<CassStatement*()> Binder;
+
+        // binds from its own copy of vals, to bind again after a reprepare
+        template<typename... Vals>
+        static Binder make_binder(PreparedStorePtr prep_store, const Vals&... vals)
+        {
+            return [prep_store, vals...]() 
+                   { 
+                       return prep_store->new_statement(bulk_writer_detail::as_bound(vals)...); 
+                   };
+        }
+
+        struct Pending
+        {
+            Binder m_binder;
+            StoreHolderPtr m_holder;
+            unsigned m_attempts;
+            unsigned m_generation;  // m_generation when sent
+        };
+
+        // binds a statement with binder and sends it
+        void send(Binder binder, unsigned attempts = 0);
+
+        // true if pending failed in a way that is safe to send again
+        bool can_retry(Pending& pending);
+
+        // reaps what is done, then waits on the oldest until under the window.
+        // Returns false if a store failed for good.
+        bool make_room();
+
+        // waits for pending. A failed store is sent again if it has retries left,
+        // returns false if it has none.
+        bool reap(Pending& pending);
+
+        PreparedStorePtr m_prep_store;
+        unsigned m_window;
+        unsigned m_max_retries;
+        bool m_idempotent;
+        unsigned m_generation;  // bumped on each reprepare
+
+        std::deque<Pending> m_pending;
+        Summary m_summary;
+        bool m_ok;      // no failures since the last flush
+    };
+}
+
+#endif 
+
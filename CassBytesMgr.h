@@ -4,6 +4,7 @@
 #include <algorithm>
 #include <iostream>
 #include <vector>
+#include <utility>
 #include <boost/make_shared.hpp>
 #include <cassandra.h>
 
@@ -15,11 +16,22 @@ namespace cb {
     {
     public:
 
+        typedef std::vector<cass_byte_t> Bytes;
+
         CassBytesMgr()
         {
         }
 
-        typedef std::vector<cass_byte_t> Bytes;
+        // takes over the buffer without copying it
+        explicit CassBytesMgr(Bytes&& buffer)
+        : m_buffer(std::move(buffer))
+        {
+        }
+
+        CassBytesMgr(const CassBytesMgr&) = default;
+        CassBytesMgr(CassBytesMgr&&) = default;
+        CassBytesMgr& operator=(const CassBytesMgr&) = default;
+        CassBytesMgr& operator=(CassBytesMgr&&) = default;
 
         const Bytes& data() const
         {
@@ -53,6 +65,29 @@ namespace cb {
             }
         }
 
+        // takes over the buffer without copying it
+        void assign(Bytes&& other)
+        {
+            m_buffer = std::move(other);
+        }
+
+        // hands the buffer back, leaving this empty
+        Bytes release()
+        {
+            Bytes retVal;
+            retVal.swap(m_buffer);
+            return retVal;
+        }
+
+        // points at the buffer, valid until this changes
+        CassBytes view() const
+        {
+            CassBytes retVal;
+            retVal.data = m_buffer.empty() ? 0 : &m_buffer.front();
+            retVal.size = m_buffer.size();
+            return retVal;
+        }
+
         void push_back(uint8_t byte)
         {
             m_buffer.push_back(byte);
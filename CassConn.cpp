@@ -1,4 +1,6 @@
 #include <atomic>
+#include <chrono>
+#include <functional>
 #include <string.h>
 #include <boost/make_shared.hpp>
 #include <boost/algorithm/string.hpp>
@@ -12,6 +14,10 @@
 #include "cql-interface/CassConn.h"
 #include "cql-interface/Fetcher.h"
 #include "cql-interface/PreparedStore.h"
+#include "cql-interface/PreparedFetch.h"
+#include "cql-interface/BatchBuilder.h"
+#include "cql-interface/CqlTemplate.h"
+#include "cql-interface/StatementCache.h"
 
 using namespace cb;
 using namespace std;
@@ -23,6 +29,9 @@ namespace {
     cass_duration_t g_timeout_in_micro = 5000000;
     CassConsistency g_consist = CASS_CONSISTENCY_LOCAL_QUORUM;
 
+    // size of the driver pending request queue, set in static_init
+    unsigned g_queue_size_io = 4096;
+
     struct CallStats
     {
         CallStats()
@@ -30,6 +39,7 @@ namespace {
             m_call = 0;
             m_timeout = 0;
             m_bad = 0;
+            m_reprepare = 0;
         }
 
         void set_value_of(CassConn::Stats& stats)
@@ -37,16 +47,40 @@ namespace {
             stats.m_call = m_call.exchange(0);
             stats.m_timeout = m_timeout.exchange(0);
             stats.m_bad = m_bad.exchange(0);
+            stats.m_reprepare = m_reprepare.exchange(0);
         }
 
         atomic<uint64_t> m_call;
         atomic<uint64_t> m_timeout;
         atomic<uint64_t> m_bad;
+        atomic<uint64_t> m_reprepare;
     };
     CallStats fetched;
     CallStats stored;
     CallStats truncated;
 
+    struct PagingStats
+    {
+        PagingStats()
+        {
+            m_pages = 0;
+            m_rows = 0;
+            m_wait_micro = 0;
+        }
+
+        void set_value_of(CassConn::PageStats& stats)
+        {
+            stats.m_pages = m_pages.exchange(0);
+            stats.m_rows = m_rows.exchange(0);
+            stats.m_wait_micro = m_wait_micro.exchange(0);
+        }
+
+        atomic<uint64_t> m_pages;
+        atomic<uint64_t> m_rows;
+        atomic<uint64_t> m_wait_micro;
+    };
+    PagingStats paged;
+
     atomic<bool> active_logger(true);
     void CassLogger(cass_uint64_t time,
                     CassLogLevel severity,
@@ -244,6 +278,389 @@ namespace {
     boost::shared_ptr<CassBase> cass_base;
     CassSession* empty_session = 0;
 
+    // off until CassConn::set_statement_cache is called
+    StatementCache stmt_cache;
+
+    // see CassConn::set_page_mode
+    atomic<CassConn::PAGE_MODE_ENUM> page_mode(CassConn::PAGE_PREFETCH_ENUM);
+
+    // returns null on failure, with timed_out set if we gave up waiting
+    const CassPrepared* prepare_query(CassSession* use_session,
+                                      const std::string& query, 
+                                      cass_duration_t timeout_in_micro,
+                                      bool& timed_out)
+    {
+        const CassPrepared* retVal = 0;
+        timed_out = false;
+        CassFuture* future = cass_session_prepare(use_session, cass_string_init(query.c_str()));
+
+        if (!cass_future_wait_timed(future, timeout_in_micro))
+        {
+            timed_out = true;
+            LOG4CXX_ERROR(logger, "calling prepare: \"" << query 
+                                    << "\" had local timeout");
+        } else
+        {
+            CassError rc = cass_future_error_code(future);
+            if (rc == CASS_OK)
+            {
+                retVal = cass_future_get_prepared(future);
+                LOG4CXX_DEBUG(logger, "prepared: \"" << query << "\"");
+            } else
+            {
+                CassString message = cass_future_error_message(future);
+                LOG4CXX_ERROR(logger, "calling prepare: \"" << query 
+                                        << "\" has error: " << string(message.data, message.length));
+            }
+        }
+        cass_future_free(future);
+        return retVal;
+    }
+
+    CassFuture* execute_text(CassSession* use_session,
+                             const std::string& query, 
+                             CassConsistency consist)
+    {
+        CassStatement* statement = cass_statement_new(cass_string_init(query.c_str()), 0);
+        cass_statement_set_consistency(statement, consist);
+        CassFuture* future = cass_session_execute(use_session, statement);
+        cass_statement_free(statement);
+        return future;
+    }
+
+    // waits on a fetch future and frees it. result is left null unless the fetch
+    // worked, in which case the caller frees it.
+    bool wait_result(CassFuture* future, 
+                     const std::string& query,
+                     cass_duration_t timeout_in_micro,
+                     const CassResult*& result)
+    {
+        bool retVal = false;
+        result = 0;
+        if (!future)
+        {
+            LOG4CXX_ERROR(logger, "getting null future in CassConn::process_future");
+            return retVal;
+        }
+        if (!cass_future_wait_timed(future, timeout_in_micro))
+        {
+            fetched.m_timeout.fetch_add(1);
+            LOG4CXX_ERROR(logger, "calling fetch: \"" << query 
+                                    << "\" had local timeout");
+        } else
+        {
+            CassError rc = cass_future_error_code(future);
+            if(rc == CASS_OK) 
+            {
+                retVal = true;
+                fetched.m_call.fetch_add(1);
+                result = cass_future_get_result(future);
+                if (!result)
+                {
+                    LOG4CXX_ERROR(logger, "fetcher.fetch getting null result for query: " << query);
+                }
+            } else if(rc == CASS_ERROR_SERVER_READ_TIMEOUT) 
+            {
+                fetched.m_timeout.fetch_add(1);
+                LOG4CXX_ERROR(logger, "calling fetch: \"" << query 
+                                        << "\" had server side timeout");
+            } else
+            {
+                fetched.m_bad.fetch_add(1);
+                CassString message = cass_future_error_message(future);
+                LOG4CXX_ERROR(logger, "calling fetch: \"" << query 
+                                        << "\" has error: " << string(message.data, message.length));
+            }
+        }
+        cass_future_free(future);
+        return retVal;
+    }
+
+    // runs the rows of result through fetcher. Stops after max_rows, if not 0.
+    // nrows is the number of rows given to the fetcher.
+    bool process_result(const CassResult* result, 
+                        CassFetcher& fetcher, 
+                        const std::string& query,
+                        uint64_t max_rows,
+                        uint64_t& nrows)
+    {
+        bool retVal = true;
+        nrows = 0;
+        CassIterator* iterator = cass_iterator_from_result(result);
+        if (iterator)
+        {
+            // a throw ends the loop anyway, so catch outside of it.
+            // begin_result too, it can run out of memory reserving for the rows.
+            try
+            {
+                fetcher.begin_result(*result);
+                while(retVal && (!max_rows || nrows < max_rows) && cass_iterator_next(iterator)) {
+                    const CassRow* row = cass_iterator_get_row(iterator);
+                    if (row)
+                    {
+                        ++nrows;
+                        retVal = fetcher.fetch(*row);
+                    } else
+                    {
+                        LOG4CXX_ERROR(logger, "fetch: \"" << query << "\" getting null row");
+                        retVal = false;
+                    }
+                }
+            } catch(std::exception& e)
+            {
+                retVal = false;
+                LOG4CXX_ERROR(logger, "Exception in fetcher for query: " << query
+                                        << " error: " << e.what());
+            }
+            LOG4CXX_TRACE(logger, "fetch: \"" << query 
+                                    << "\" returned " << nrows 
+                                    << " rows");
+            cass_iterator_free(iterator);
+        } else
+        {
+            LOG4CXX_ERROR(logger, "fetcher.fetch getting null iterator for query: " << query);
+        }
+        return retVal;
+    }
+
+    // makes the statement for the next page. Continues after result, if not null.
+    // Returns null on failure.
+    CassFuture* execute_page(CassSession* use_session,
+                             const std::function<CassStatement*()>& new_statement,
+                             const std::string& query,
+                             unsigned page_size,
+                             uint64_t max_rows,
+                             uint64_t rows_so_far,
+                             const CassResult* result)
+    {
+        CassStatement* statement = 0;
+        try
+        {
+            statement = new_statement();
+        } catch(std::exception& e)
+        {
+            fetched.m_bad.fetch_add(1);
+            LOG4CXX_ERROR(logger, "Exception making page statement for query: " << query
+                                    << " error: " << e.what());
+            return 0;
+        }
+
+        // no need to fetch more than is left on the last page
+        uint64_t use_page_size = page_size;
+        if (max_rows && max_rows - rows_so_far < use_page_size)
+        {
+            use_page_size = max_rows - rows_so_far;
+        }
+        cass_statement_set_paging_size(statement, int(use_page_size));
+        if (result)
+        {
+            cass_statement_set_paging_state(statement, result);
+        }
+        CassFuture* future = cass_session_execute(use_session, statement);
+        cass_statement_free(statement);
+        return future;
+    }
+
+    // waits for a page and frees future. Returns null on failure, after counting it.
+    const CassResult* wait_page(CassFuture* future,
+                                const std::string& query,
+                                unsigned page_num,
+                                cass_duration_t timeout_in_micro,
+                                bool* was_unprepared)
+    {
+        auto start = std::chrono::steady_clock::now();
+        bool is_done = cass_future_wait_timed(future, timeout_in_micro);
+        paged.m_wait_micro.fetch_add(std::chrono::duration_cast<std::chrono::microseconds>(
+                                        std::chrono::steady_clock::now() - start).count());
+
+        const CassResult* result = 0;
+        if (!is_done)
+        {
+            fetched.m_timeout.fetch_add(1);
+            LOG4CXX_ERROR(logger, "calling fetch: \"" << query 
+                                    << "\" had local timeout on page " << page_num);
+        } else
+        {
+            CassError rc = cass_future_error_code(future);
+            if (rc == CASS_OK)
+            {
+                result = cass_future_get_result(future);
+                if (!result)
+                {
+                    LOG4CXX_ERROR(logger, "fetcher.fetch getting null result for query: " << query);
+                }
+            } else if (rc == CASS_ERROR_SERVER_READ_TIMEOUT)
+            {
+                fetched.m_timeout.fetch_add(1);
+                LOG4CXX_ERROR(logger, "calling fetch: \"" << query 
+                                        << "\" had server side timeout on page " << page_num);
+            } else if (rc == CASS_ERROR_SERVER_UNPREPARED && was_unprepared && !page_num)
+            {
+                // caller will prepare again and retry, so not a bad call yet
+                fetched.m_reprepare.fetch_add(1);
+                *was_unprepared = true;
+                LOG4CXX_WARN(logger, "calling fetch: \"" << query 
+                                        << "\" was no longer prepared on the server");
+            } else
+            {
+                fetched.m_bad.fetch_add(1);
+                CassString message = cass_future_error_message(future);
+                LOG4CXX_ERROR(logger, "calling fetch: \"" << query 
+                                        << "\" has error on page " << page_num 
+                                        << ": " << string(message.data, message.length));
+            }
+        }
+        cass_future_free(future);
+        return result;
+    }
+
+    // fetches page_size rows at a time, running each page through fetcher.
+    // new_statement makes a fresh statement for each page, since a statement
+    // can't be changed while the driver may still be sending it.
+    // In PAGE_PREFETCH_ENUM mode the next page is asked for as soon as a page
+    // arrives, so it is on the way while this page is decoded.
+    // Counts one fetch call when all pages are done. was_unprepared, if given,
+    // is set if the first page finds the server no longer knows the prepared id.
+    bool fetch_pages(CassSession* use_session,
+                     const std::function<CassStatement*()>& new_statement,
+                     CassFetcher& fetcher, 
+                     const std::string& query,
+                     unsigned page_size,
+                     uint64_t max_rows,
+                     cass_duration_t timeout_in_micro,
+                     bool* was_unprepared)
+    {
+        bool prefetch = (page_mode == CassConn::PAGE_PREFETCH_ENUM);
+        uint64_t total_rows = 0;
+        unsigned npages = 0;
+        CassFuture* future = execute_page(use_session, new_statement, query, 
+                                          page_size, max_rows, 0, 0);
+        if (!future)
+        {
+            return false;
+        }
+        while (future)
+        {
+            const CassResult* result = wait_page(future, query, npages, timeout_in_micro, was_unprepared);
+            if (!result)
+            {
+                return false;
+            }
+
+            uint64_t rows_after = total_rows + cass_result_row_count(result);
+            bool more = cass_result_has_more_pages(result) && (!max_rows || rows_after < max_rows);
+            CassFuture* next = 0;
+            if (more && prefetch)
+            {
+                next = execute_page(use_session, new_statement, query, 
+                                    page_size, max_rows, rows_after, result);
+            }
+
+            uint64_t nrows = 0;
+            bool ok = process_result(result, fetcher, query, 
+                                     max_rows ? max_rows - total_rows : 0, nrows);
+            total_rows += nrows;
+            ++npages;
+            paged.m_pages.fetch_add(1);
+            paged.m_rows.fetch_add(nrows);
+
+            if (ok && more && !prefetch)
+            {
+                next = execute_page(use_session, new_statement, query, 
+                                    page_size, max_rows, total_rows, result);
+            }
+            cass_result_free(result);
+            if (!ok || (more && !next))
+            {
+                if (next)
+                {
+                    cass_future_free(next);
+                }
+                return false;
+            }
+            future = next;
+        }
+        fetched.m_call.fetch_add(1);
+        LOG4CXX_TRACE(logger, "fetch: \"" << query << "\" returned " << total_rows 
+                                << " rows in " << npages << " pages");
+        return true;
+    }
+
+    // executes a text query. When the statement cache is on, the statement is bound 
+    // from the cached prepared statement for the query's template and entry is set.
+    CassFuture* execute_query(CassSession* use_session,
+                              const std::string& query, 
+                              CassConsistency consist,
+                              cass_duration_t timeout_in_micro,
+                              StatementCache::EntryPtr& entry)
+    {
+        entry.reset();
+        CqlTemplate cql;
+        if (!stmt_cache.enabled() || !cql.parse(query))
+        {
+            return execute_text(use_session, query, consist);
+        }
+
+        StatementCache::EntryPtr found = stmt_cache.find(cql.key());
+        if (!found)
+        {
+            bool timed_out = false;
+            const CassPrepared* prepared = prepare_query(use_session, cql.text(), 
+                                                         timeout_in_micro, timed_out);
+            if (prepared || !timed_out)
+            {
+                // a template the server will not prepare is kept as a text only entry
+                found = std::make_shared<StatementCache::Entry>(cql.key(), prepared);
+                stmt_cache.insert(found);
+            }
+        }
+        if (!found || !found->m_prepared)
+        {
+            return execute_text(use_session, query, consist);
+        }
+
+        CassStatement* statement = cass_prepared_bind(found->m_prepared, cql.literals().size());
+        if (!statement)
+        {
+            return execute_text(use_session, query, consist);
+        }
+        if (!cql.bind(statement))
+        {
+            LOG4CXX_DEBUG(logger, "failed binding literals for: \"" << query << "\"");
+            cass_statement_free(statement);
+            return execute_text(use_session, query, consist);
+        }
+        cass_statement_set_consistency(statement, consist);
+        CassFuture* future = cass_session_execute(use_session, statement);
+        cass_statement_free(statement);
+        entry = found;
+        return future;
+    }
+
+    // true if the server turned down a statement bound from a cached prepared
+    // statement, where the text query may still work. Fixes up the cache so the
+    // next call with this template does not hit the same problem.
+    bool rejected_prepared(CassFuture* future, const StatementCache::EntryPtr& entry)
+    {
+        if (!entry)
+        {
+            return false;
+        }
+        CassError rc = cass_future_error_code(future);
+        if (rc == CASS_ERROR_SERVER_UNPREPARED)
+        {
+            // prepare again on the next call
+            stmt_cache.erase(entry->m_key);
+            return true;
+        } else if (rc == CASS_ERROR_SERVER_INVALID_QUERY)
+        {
+            // literal types do not match the columns, so run this template as text
+            stmt_cache.insert(std::make_shared<StatementCache::Entry>(entry->m_key, nullptr));
+            return true;
+        }
+        return false;
+    }
+
     class TestIfAppliedFetcher : public CassFetcher
     {
     public:
@@ -292,6 +709,7 @@ void CassConn::static_init(const std::set<std::string>& ip_list,
                             );
     g_timeout_in_micro = use_timeout_in_micro;
     g_consist = consist;
+    g_queue_size_io = queue_size_io;
     cass_base.reset(new CassBase(ip_list, 
                                  keyspace, 
                                  login, 
@@ -332,39 +750,25 @@ bool CassConn::store(const std::string& query,
 
     if (use_session)
     {
-        CassFuture* future = NULL;
-        CassStatement* statement = cass_statement_new(cass_string_init(query.c_str()), 0);
-        cass_statement_set_consistency(statement, consist);
-        
-        future = cass_session_execute(use_session, statement);
-        cass_statement_free(statement);
+        StatementCache::EntryPtr entry;
+        CassFuture* future = execute_query(use_session, query, consist, timeout_in_micro, entry);
 
-        if (!cass_future_wait_timed(future, timeout_in_micro))
-        {
-            stored.m_timeout.fetch_add(1);
-            LOG4CXX_ERROR(logger, "calling store: \"" << query 
-                                    << "\" had local timeout");
-        } else
+        if (entry)
         {
-            CassError rc = cass_future_error_code(future);
-            if(rc == CASS_OK) 
+            if (!cass_future_wait_timed(future, timeout_in_micro))
             {
-                retVal = true;
-                stored.m_call.fetch_add(1);
-                LOG4CXX_TRACE(logger, "executed: \"" << query << "\"");
-            } else if(rc == CASS_ERROR_SERVER_WRITE_TIMEOUT) 
+                // already waited out the timeout, process_store_future should not wait again
+                timeout_in_micro = 0;
+            } else if (rejected_prepared(future, entry))
             {
-                stored.m_timeout.fetch_add(1);
-                LOG4CXX_ERROR(logger, "calling store: \"" << query 
-                                        << "\" had server side timeout");
-            } else
-            {
-                stored.m_bad.fetch_add(1);
-                CassString message = cass_future_error_message(future);
-                LOG4CXX_ERROR(logger, "calling store: \"" << query 
-                                        << "\" has error: " << string(message.data, message.length));
+                LOG4CXX_DEBUG(logger, "calling store: \"" << query 
+                                        << "\" as text after prepared statement failed");
+                cass_future_free(future);
+                future = execute_text(use_session, query, consist);
             }
         }
+
+        retVal = process_store_future(future, query, timeout_in_micro);
         cass_future_free(future);
     } else
     {
@@ -373,6 +777,185 @@ bool CassConn::store(const std::string& query,
     return retVal;
 }
 
+bool CassConn::async_store(const std::string& query, 
+                           StoreHolderPtr store_holder)
+{
+    return async_store(query, store_holder, g_consist, g_timeout_in_micro);
+}
+
+bool CassConn::async_store(const std::string& query, 
+                           StoreHolderPtr store_holder,
+                           CassConsistency consist, 
+                           cass_duration_t timeout_in_micro_in)
+{
+    bool retVal = false;
+    CassSession* use_session = cass_base ? cass_base->session() : empty_session;
+
+    cass_duration_t timeout_in_micro = (timeout_in_micro_in 
+                                         ? timeout_in_micro_in 
+                                         : g_timeout_in_micro);
+
+    if (use_session && store_holder)
+    {
+        CassFuture* future = execute_text(use_session, query, consist);
+        retVal = store_holder->assign(future, query, timeout_in_micro);
+    } else if (!store_holder)
+    {
+        LOG4CXX_ERROR(logger, "calling store: \"" << query << "\" with null StoreHolderPtr");
+    } else
+    {
+        LOG4CXX_ERROR(logger, "calling store: \"" << query << "\" before cassandra is initialized");
+    }
+    if (!retVal && store_holder)
+    {
+        // make sure there is no residual store holder content
+        store_holder->clear();
+    }
+    return retVal;
+}
+
+bool CassConn::async_store(const PreparedStore& prep_store, 
+                           CassStatement* statement,
+                           StoreHolderPtr store_holder)
+{
+    bool retVal = false;
+    CassSession* use_session = cass_base ? cass_base->session() : empty_session;
+
+    if (use_session && store_holder)
+    {
+        CassFuture* future = cass_session_execute(use_session, statement);
+        retVal = store_holder->assign(future, prep_store.query(), prep_store.timeout_in_micro());
+    } else if (!store_holder)
+    {
+        LOG4CXX_ERROR(logger, "calling store: \"" << prep_store.query() << "\" with null StoreHolderPtr");
+    } else
+    {
+        LOG4CXX_ERROR(logger, "calling store: \"" << prep_store.query() << "\" before cassandra is initialized");
+    }
+    if (!retVal && store_holder)
+    {
+        store_holder->clear();
+    }
+    return retVal;
+}
+
+bool CassConn::store(BatchBuilder& batch_builder)
+{
+    bool retVal = false;
+    CassSession* use_session = cass_base ? cass_base->session() : empty_session;
+    string desc = batch_builder.description();
+
+    cass_duration_t timeout_in_micro = (batch_builder.m_timeout_in_micro 
+                                         ? batch_builder.m_timeout_in_micro 
+                                         : g_timeout_in_micro);
+
+    CassBatch* batch = batch_builder.release();
+    if (use_session && batch)
+    {
+        cass_batch_set_consistency(batch, batch_builder.m_has_consist ? batch_builder.m_consist : g_consist);
+        CassFuture* future = cass_session_execute_batch(use_session, batch);
+        retVal = process_store_future(future, desc, timeout_in_micro);
+        cass_future_free(future);
+    } else if (batch)
+    {
+        LOG4CXX_ERROR(logger, "calling store: \"" << desc << "\" before cassandra is initialized");
+    }
+    if (batch)
+    {
+        cass_batch_free(batch);
+    }
+    return retVal;
+}
+
+bool CassConn::async_store(BatchBuilder& batch_builder,
+                           StoreHolderPtr store_holder)
+{
+    bool retVal = false;
+    CassSession* use_session = cass_base ? cass_base->session() : empty_session;
+    string desc = batch_builder.description();
+
+    cass_duration_t timeout_in_micro = (batch_builder.m_timeout_in_micro 
+                                         ? batch_builder.m_timeout_in_micro 
+                                         : g_timeout_in_micro);
+
+    CassBatch* batch = batch_builder.release();
+    if (use_session && store_holder && batch)
+    {
+        cass_batch_set_consistency(batch, batch_builder.m_has_consist ? batch_builder.m_consist : g_consist);
+        CassFuture* future = cass_session_execute_batch(use_session, batch);
+        retVal = store_holder->assign(future, desc, timeout_in_micro);
+    } else if (!store_holder)
+    {
+        LOG4CXX_ERROR(logger, "calling store: \"" << desc << "\" with null StoreHolderPtr");
+    } else if (!batch)
+    {
+        LOG4CXX_ERROR(logger, "calling store: \"" << desc << "\" with empty batch");
+    } else
+    {
+        LOG4CXX_ERROR(logger, "calling store: \"" << desc << "\" before cassandra is initialized");
+    }
+    if (batch)
+    {
+        cass_batch_free(batch);
+    }
+    if (!retVal && store_holder)
+    {
+        store_holder->clear();
+    }
+    return retVal;
+}
+
+bool CassConn::process_store_future(CassFuture* future, 
+                                    const std::string& query,
+                                    cass_duration_t timeout_in_micro,
+                                    bool* was_unprepared)
+{
+    bool retVal = false;
+    if (was_unprepared)
+    {
+        *was_unprepared = false;
+    }
+    if (!future)
+    {
+        LOG4CXX_ERROR(logger, "getting null future in CassConn::process_store_future");
+        return retVal;
+    }
+    if (!cass_future_wait_timed(future, timeout_in_micro))
+    {
+        stored.m_timeout.fetch_add(1);
+        LOG4CXX_ERROR(logger, "calling store: \"" << query 
+                                << "\" had local timeout");
+    } else
+    {
+        CassError rc = cass_future_error_code(future);
+        if(rc == CASS_OK) 
+        {
+            retVal = true;
+            stored.m_call.fetch_add(1);
+            LOG4CXX_TRACE(logger, "executed: \"" << query << "\"");
+        } else if(rc == CASS_ERROR_SERVER_WRITE_TIMEOUT) 
+        {
+            stored.m_timeout.fetch_add(1);
+            LOG4CXX_ERROR(logger, "calling store: \"" << query 
+                                    << "\" had server side timeout");
+        } else if(rc == CASS_ERROR_SERVER_UNPREPARED && was_unprepared) 
+        {
+            // caller will prepare again and retry, so not a bad call yet
+            stored.m_reprepare.fetch_add(1);
+            *was_unprepared = true;
+            LOG4CXX_WARN(logger, "calling store: \"" << query 
+                                    << "\" was no longer prepared on the server");
+        } else
+        {
+            stored.m_bad.fetch_add(1);
+            CassString message = cass_future_error_message(future);
+            LOG4CXX_ERROR(logger, "calling store: \"" << query 
+                                    << "\" has error: " << string(message.data, message.length));
+        }
+    }
+    return retVal;
+}
+
 PreparedStorePtr CassConn::prepare_store(const std::string& query, unsigned num_args)
 {
     return prepare_store(query, num_args, g_consist, g_timeout_in_micro);
@@ -389,61 +972,76 @@ PreparedStorePtr CassConn::prepare_store(const std::string& query,
                                          ? timeout_in_micro_in 
                                          : g_timeout_in_micro);
 
+    const CassPrepared* prepared = prepare(query, timeout_in_micro);
+    if (prepared)
+    {
+        // can't use make_shared since constructor is protected
+        retVal.reset(new PreparedStore(query, prepared, num_args, consist, timeout_in_micro));
+    }
+    return retVal;
+}
+
+PreparedFetchPtr CassConn::prepare_fetch(const std::string& query, unsigned num_args)
+{
+    return prepare_fetch(query, num_args, g_consist, g_timeout_in_micro);
+}
+
+PreparedFetchPtr CassConn::prepare_fetch(const std::string& query, 
+                                         unsigned num_args, 
+                                         CassConsistency consist, 
+                                         cass_duration_t timeout_in_micro_in)
+{
+    PreparedFetchPtr retVal;
+
+    cass_duration_t timeout_in_micro = (timeout_in_micro_in 
+                                         ? timeout_in_micro_in 
+                                         : g_timeout_in_micro);
+
+    const CassPrepared* prepared = prepare(query, timeout_in_micro);
+    if (prepared)
+    {
+        // can't use make_shared since constructor is protected
+        retVal.reset(new PreparedFetch(query, prepared, num_args, consist, timeout_in_micro));
+    }
+    return retVal;
+}
+
+const CassPrepared* CassConn::prepare(const std::string& query, 
+                                      cass_duration_t timeout_in_micro)
+{
+    const CassPrepared* retVal = 0;
     CassSession* use_session = cass_base ? cass_base->session() : empty_session;
 
     if (use_session)
     {
-        CassStatement* statement = cass_statement_new(cass_string_init(query.c_str()), num_args);
-
-        if (statement)
-        {
-            cass_statement_set_consistency(statement, consist);
-            // can't use make_shared since constructor is protected
-            retVal.reset(new PreparedStore(query, statement, num_args, timeout_in_micro));
-        }
+        bool timed_out = false;
+        retVal = prepare_query(use_session, query, timeout_in_micro, timed_out);
+    } else
+    {
+        LOG4CXX_ERROR(logger, "calling prepare: \"" << query << "\" before cassandra is initialized");
     }
     return retVal;
 }
 
-bool CassConn::store(PreparedStore& prep_store)
+bool CassConn::store(const PreparedStore& prep_store, 
+                     CassStatement* statement,
+                     bool& was_unprepared)
 {
     bool retVal = false;
+    was_unprepared = false;
     CassSession* use_session = cass_base ? cass_base->session() : empty_session;
 
     if (use_session)
     {
-        CassFuture* future = cass_session_execute(use_session, prep_store.m_statement);
-
-        if (!cass_future_wait_timed(future, prep_store.m_timeout_in_micro))
-        {
-            stored.m_timeout.fetch_add(1);
-            LOG4CXX_ERROR(logger, "calling store: \"" << prep_store.m_query 
-                                    << "\" had local timeout");
-        } else
-        {
-            CassError rc = cass_future_error_code(future);
-            if(rc == CASS_OK) 
-            {
-                retVal = true;
-                stored.m_call.fetch_add(1);
-                LOG4CXX_TRACE(logger, "executed: \"" << prep_store.m_query << "\"");
-            } else if(rc == CASS_ERROR_SERVER_WRITE_TIMEOUT) 
-            {
-                stored.m_timeout.fetch_add(1);
-                LOG4CXX_ERROR(logger, "calling store: \"" << prep_store.m_query 
-                                        << "\" had server side timeout");
-            } else
-            {
-                stored.m_bad.fetch_add(1);
-                CassString message = cass_future_error_message(future);
-                LOG4CXX_ERROR(logger, "calling store: \"" << prep_store.m_query 
-                                        << "\" has error: " << string(message.data, message.length));
-            }
-        }
+        CassFuture* future = cass_session_execute(use_session, statement);
+        retVal = process_store_future(future, 
+                                      prep_store.query(), 
+                                      prep_store.timeout_in_micro(), 
+                                      &was_unprepared);
         cass_future_free(future);
     } else
     {
-        LOG4CXX_ERROR(logger, "calling store: \"" << prep_store.m_query << "\" before cassandra is initialized");
+        LOG4CXX_ERROR(logger, "calling store: \"" << prep_store.query() << "\" before cassandra is initialized");
     }
     return retVal;
 }
@@ -622,7 +1220,48 @@ bool CassConn::fetch(const std::string& query,
 bool CassConn::fetch(const std::string& query, 
                      CassFetcher& fetcher,
                      CassConsistency consist, 
-                     cass_duration_t timeout_in_micro_in)
+                     cass_duration_t timeout_in_micro)
+{
+    return fetch(query, &fetcher, consist, timeout_in_micro, 0);
+}
+
+bool CassConn::fetch_result(const std::string& query, 
+                            CassFetcher& fetcher,
+                            CassResultPtr& result)
+{
+    return fetch_result(query, fetcher, result, g_consist, g_timeout_in_micro);
+}
+
+bool CassConn::fetch_result(const std::string& query, 
+                            CassFetcher& fetcher,
+                            CassResultPtr& result,
+                            CassConsistency consist, 
+                            cass_duration_t timeout_in_micro)
+{
+    result.reset();
+    return fetch(query, &fetcher, consist, timeout_in_micro, &result);
+}
+
+bool CassConn::fetch_result(const std::string& query, 
+                            CassResultPtr& result)
+{
+    return fetch_result(query, result, g_consist, g_timeout_in_micro);
+}
+
+bool CassConn::fetch_result(const std::string& query, 
+                            CassResultPtr& result,
+                            CassConsistency consist, 
+                            cass_duration_t timeout_in_micro)
+{
+    result.reset();
+    return fetch(query, 0, consist, timeout_in_micro, &result) && result;
+}
+
+bool CassConn::fetch(const std::string& query, 
+                     CassFetcher* fetcher,
+                     CassConsistency consist, 
+                     cass_duration_t timeout_in_micro_in,
+                     CassResultPtr* keep_result)
 {
     bool retVal = false;
     CassSession* use_session = cass_base ? cass_base->session() : empty_session;
@@ -633,13 +1272,35 @@ bool CassConn::fetch(const std::string& query,
 
     if (use_session)
     {
-        CassStatement* statement = cass_statement_new(cass_string_init(query.c_str()), 0);
-        cass_statement_set_consistency(statement, consist);
-        
-        CassFuture* future = cass_session_execute(use_session, statement);
-        cass_statement_free(statement);
+        StatementCache::EntryPtr entry;
+        CassFuture* future = execute_query(use_session, query, consist, timeout_in_micro, entry);
+        if (entry)
+        {
+            if (!cass_future_wait_timed(future, timeout_in_micro))
+            {
+                // already waited out the timeout, process_future should not wait again
+                timeout_in_micro = 0;
+            } else if (rejected_prepared(future, entry))
+            {
+                LOG4CXX_DEBUG(logger, "calling fetch: \"" << query 
+                                        << "\" as text after prepared statement failed");
+                cass_future_free(future);
+                future = execute_text(use_session, query, consist);
+            }
+        }
 
-        retVal = process_future(future, fetcher, query, timeout_in_micro);
+        if (fetcher)
+        {
+            retVal = process_future(future, *fetcher, query, timeout_in_micro, keep_result);
+        } else
+        {
+            const CassResult* result = 0;
+            retVal = wait_result(future, query, timeout_in_micro, result);
+            if (result)
+            {
+                keep_result->reset(result, cass_result_free);
+            }
+        }
         LOG4CXX_DEBUG(logger, "calling fetch: \"" << query << "\" "
                                 << (retVal ? "success" : "FAILED"));
     } else
@@ -649,86 +1310,168 @@ bool CassConn::fetch(const std::string& query,
     return retVal;
 }
 
-bool CassConn::process_future(CassFuture* future, 
-                              CassFetcher& fetcher, 
-                              const std::string& query,
-                              cass_duration_t timeout_in_micro)
+bool CassConn::fetch(const PreparedFetch& prep_fetch, 
+                     CassStatement* statement,
+                     CassFetcher& fetcher,
+                     bool& was_unprepared)
 {
     bool retVal = false;
-    if (!future)
+    was_unprepared = false;
+    CassSession* use_session = cass_base ? cass_base->session() : empty_session;
+
+    if (use_session)
     {
-        LOG4CXX_ERROR(logger, "getting null future in CassConn::process_future");
-        return retVal;
+        cass_duration_t timeout_in_micro = prep_fetch.timeout_in_micro();
+        CassFuture* future = cass_session_execute(use_session, statement);
+
+        if (!cass_future_wait_timed(future, timeout_in_micro))
+        {
+            // already waited out the timeout, process_future should not wait again
+            timeout_in_micro = 0;
+        } else if (cass_future_error_code(future) == CASS_ERROR_SERVER_UNPREPARED)
+        {
+            // PreparedFetch will prepare again and retry, so not a bad call yet
+            fetched.m_reprepare.fetch_add(1);
+            was_unprepared = true;
+            LOG4CXX_WARN(logger, "calling fetch: \"" << prep_fetch.query() 
+                                    << "\" was no longer prepared on the server");
+            cass_future_free(future);
+            return retVal;
+        }
+        retVal = process_future(future, fetcher, prep_fetch.query(), timeout_in_micro);
+        LOG4CXX_DEBUG(logger, "calling fetch: \"" << prep_fetch.query() << "\" "
+                                << (retVal ? "success" : "FAILED"));
+    } else
+    {
+        LOG4CXX_ERROR(logger, "calling fetch: \"" << prep_fetch.query() << "\" before cassandra is initialized");
     }
-    if (!cass_future_wait_timed(future, timeout_in_micro))
+    return retVal;
+}
+
+bool CassConn::async_fetch(const PreparedFetch& prep_fetch, 
+                           CassStatement* statement,
+                           CassFetcherPtr fetcher,
+                           CassFetcherHolderPtr fetch_holder)
+{
+    bool retVal = false;
+    CassSession* use_session = cass_base ? cass_base->session() : empty_session;
+
+    if (use_session && fetcher && fetch_holder)
     {
-        fetched.m_timeout.fetch_add(1);
-        LOG4CXX_ERROR(logger, "calling fetch: \"" << query 
-                                << "\" had local timeout");
+        CassFuture* future = cass_session_execute(use_session, statement);
+        retVal = fetch_holder->assign(future, fetcher, prep_fetch.query(), prep_fetch.timeout_in_micro());
+    } else if (!fetcher)
+    {
+        LOG4CXX_ERROR(logger, "calling fetch: \"" << prep_fetch.query() << "\" with null CassFetcherPtr");
+    } else if (!fetch_holder)
+    {
+        LOG4CXX_ERROR(logger, "calling fetch: \"" << prep_fetch.query() << "\" with null CassFetcherHolderPtr");
     } else
     {
-        CassError rc = cass_future_error_code(future);
-        if(rc == CASS_OK) 
+        LOG4CXX_ERROR(logger, "calling fetch: \"" << prep_fetch.query() << "\" before cassandra is initialized");
+    }
+    if (!retVal && fetch_holder)
+    {
+        fetch_holder->clear();
+    }
+    return retVal;
+}
+
+bool CassConn::fetch_paged(const std::string& query, 
+                           CassFetcher& fetcher,
+                           unsigned page_size,
+                           uint64_t max_rows)
+{
+    return fetch_paged(query, fetcher, page_size, max_rows, g_consist, g_timeout_in_micro);
+}
+
+bool CassConn::fetch_paged(const std::string& query, 
+                           CassFetcher& fetcher,
+                           unsigned page_size,
+                           uint64_t max_rows,
+                           CassConsistency consist, 
+                           cass_duration_t timeout_in_micro_in)
+{
+    bool retVal = false;
+    CassSession* use_session = cass_base ? cass_base->session() : empty_session;
+
+    cass_duration_t timeout_in_micro = (timeout_in_micro_in 
+                                         ? timeout_in_micro_in 
+                                         : g_timeout_in_micro);
+
+    if (!page_size)
+    {
+        LOG4CXX_ERROR(logger, "calling fetch_paged: \"" << query << "\" with page_size 0");
+    } else if (use_session)
+    {
+        auto new_statement = [&query, consist]()
         {
-            retVal = true;
-            fetched.m_call.fetch_add(1);
-            const CassResult* result = cass_future_get_result(future);
-            if (result)
-            {
-                CassIterator* iterator = cass_iterator_from_result(result);
-                if (iterator)
-                {
-                    unsigned nrows = 0;
-                    while(retVal && cass_iterator_next(iterator)) {
-                        const CassRow* row = cass_iterator_get_row(iterator);
-                        if (row)
-                        {
-                            ++nrows;
-                            try
-                            {
-                                retVal = fetcher.fetch(*row);
-                            } catch(std::exception& e)
-                            {
-                                retVal = false;
-                                LOG4CXX_ERROR(logger, "Exception in fetcher.fetch for query: " << query
-                                                        << " error: " << e.what());
-                            }
-                        } else
-                        {
-                            LOG4CXX_ERROR(logger, "fetch: \"" << query << "\" getting null row");
-                            retVal = false;
-                        }
-                    }
-                    LOG4CXX_TRACE(logger, "fetch: \"" << query 
-                                            << "\" returned " << nrows 
-                                            << " rows");
-                    cass_iterator_free(iterator);
-                } else
-                {
-                    LOG4CXX_ERROR(logger, "fetcher.fetch getting null iterator for query: " << query);
-                }
-                cass_result_free(result);
-            } else
-            {
-                LOG4CXX_ERROR(logger, "fetcher.fetch getting null result for query: " << query);
-            }
-        } else if(rc == CASS_ERROR_SERVER_READ_TIMEOUT) 
+            CassStatement* statement = cass_statement_new(cass_string_init(query.c_str()), 0);
+            cass_statement_set_consistency(statement, consist);
+            return statement;
+        };
+        retVal = fetch_pages(use_session, new_statement, fetcher, query, 
+                             page_size, max_rows, timeout_in_micro, 0);
+    } else
+    {
+        LOG4CXX_ERROR(logger, "calling fetch: \"" << query << "\" before cassandra is initialized");
+    }
+    return retVal;
+}
+
+bool CassConn::fetch_paged(const PreparedFetch& prep_fetch, 
+                           const std::function<CassStatement*()>& new_statement,
+                           CassFetcher& fetcher,
+                           unsigned page_size,
+                           uint64_t max_rows,
+                           bool& was_unprepared)
+{
+    bool retVal = false;
+    was_unprepared = false;
+    CassSession* use_session = cass_base ? cass_base->session() : empty_session;
+
+    if (!page_size)
+    {
+        LOG4CXX_ERROR(logger, "calling fetch_paged: \"" << prep_fetch.query() << "\" with page_size 0");
+    } else if (use_session)
+    {
+        retVal = fetch_pages(use_session, new_statement, fetcher, prep_fetch.query(),
+                             page_size, max_rows, prep_fetch.timeout_in_micro(), &was_unprepared);
+    } else
+    {
+        LOG4CXX_ERROR(logger, "calling fetch: \"" << prep_fetch.query() << "\" before cassandra is initialized");
+    }
+    return retVal;
+}
+
+bool CassConn::process_future(CassFuture* future, 
+                              CassFetcher& fetcher, 
+                              const std::string& query,
+                              cass_duration_t timeout_in_micro,
+                              CassResultPtr* keep_result)
+{
+    const CassResult* result = 0;
+    bool retVal = wait_result(future, query, timeout_in_micro, result);
+    if (result)
+    {
+        uint64_t nrows = 0;
+        retVal = process_result(result, fetcher, query, 0, nrows);
+        if (keep_result)
         {
-            fetched.m_timeout.fetch_add(1);
-            LOG4CXX_ERROR(logger, "calling fetch: \"" << query 
-                                    << "\" had server side timeout");
+            keep_result->reset(result, cass_result_free);
         } else
         {
-            fetched.m_bad.fetch_add(1);
-            CassString message = cass_future_error_message(future);
-            LOG4CXX_ERROR(logger, "calling fetch: \"" << query 
-                                    << "\" has error: " << string(message.data, message.length));
+            cass_result_free(result);
         }
     }
-    cass_future_free(future);
     return retVal;
 }
 
+void CassConn::log_row_exception(const std::exception& e)
+{
+    LOG4CXX_ERROR(logger, "Exception in for_each_row, error: " << e.what());
+}
+
 void CassConn::set_uuid_rand(CassUuid uuid)
 {
     cass_uuid_generate_random(uuid);
@@ -781,9 +1524,31 @@ void CassConn::escape(std::ostream& os, const std::string& text)
     }
 }
 
+void CassConn::set_page_mode(PAGE_MODE_ENUM mode)
+{
+    LOG4CXX_INFO(logger, "setting page mode: " 
+                            << (mode == PAGE_PREFETCH_ENUM ? "prefetch" : "sequential"));
+    page_mode = mode;
+}
+
+void CassConn::set_statement_cache(size_t max_entries)
+{
+    LOG4CXX_INFO(logger, "setting statement cache max_entries: " << max_entries);
+    stmt_cache.set_max_entries(max_entries);
+}
+
+unsigned CassConn::get_queue_size_io()
+{
+    return g_queue_size_io;
+}
+
 void CassConn::get_stats(CassConn::FullStats& stats)
 {
     fetched.set_value_of(stats.m_fetched);
     stored.set_value_of(stats.m_stored);
     truncated.set_value_of(stats.m_truncated);
+    paged.set_value_of(stats.m_paged);
+    stmt_cache.take_stats(stats.m_stmt_cache.m_hit, 
+                          stats.m_stmt_cache.m_miss, 
+                          stats.m_stmt_cache.m_evict);
 }
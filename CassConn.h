@@ -1,18 +1,26 @@
 #ifndef CB_CASS_CONN_H
 #define CB_CASS_CONN_H
 
+#include <exception>
 #include <memory>
 #include <string>
+#include <functional>
 #include <set>
 #include <cassandra.h>
 #include "cql-interface/CassFetcherHolder.h"
+#include "cql-interface/StoreHolder.h"
 
 #define CASS_UUID_NUM_BYTES  16
 
 namespace cb {
 
     class RefIdImp;
+    class PreparedStatement;
     class PreparedStore;
+    class PreparedFetch;
+    class BatchBuilder;
+    class BulkWriter;
+    template<typename... Args> class TypedPreparedStore;
 
     enum UUID_TYPE_ENUM { TIMEUUID_ENUM, UUID_ENUM};
     class CassConn {
@@ -54,8 +62,21 @@ namespace cb {
                           CassConsistency consist,
                           cass_duration_t timeout_in_micro = 0);
 
+        // the StoreHolder holds the store processing asyncronously. Wait on it, poll it
+        // or give it a completion callback. See StoreHolder.
+        // These do not go through the statement cache.
+        static bool async_store(const std::string& query, 
+                                StoreHolderPtr store_holder);
+        static bool async_store(const std::string& query, 
+                                StoreHolderPtr store_holder,
+                                CassConsistency consist,
+                                cass_duration_t timeout_in_micro = 0);
+
         // now same for prepared statements which will store later with bound values
-        // returns null PreparedStorePtr in most failure cases.
+        // The query is prepared once on the server (cass_session_prepare) and each
+        // store binds a fresh statement from it, so the server does not parse it again.
+        // returns null PreparedStorePtr in most failure cases, including the server
+        // rejecting the query when preparing it.
         // could throw if there is an unexpected error.
         // Should return a PreparedStorePtr which you can use to make store commands with
         // bound variables.
@@ -65,6 +86,14 @@ namespace cb {
                                                             CassConsistency consist,
                                                             cass_duration_t timeout_in_micro = 0);
           
+        // prepared select statements, which fetch with bound values into any CassFetcher.
+        // Same failure handling as prepare_store.
+        static std::shared_ptr<PreparedFetch> prepare_fetch(const std::string& query, unsigned num_args);
+        static std::shared_ptr<PreparedFetch> prepare_fetch(const std::string& query, 
+                                                            unsigned num_args, 
+                                                            CassConsistency consist,
+                                                            cass_duration_t timeout_in_micro = 0);
+
         // note that " if not exists " is added by the call.
         static bool store_if_not_exists(const std::string& query);
         static bool store_if_not_exists(const std::string& query, 
@@ -102,6 +131,100 @@ namespace cb {
                           CassConsistency consist,
                           cass_duration_t timeout_in_micro = 0);
 
+        // same as fetch, but result keeps the result alive afterwards instead of
+        // it being freed once the rows are through the fetcher. So the fetcher can
+        // keep CassString and CassBytes views of text and blob values rather than
+        // copies; they are good for as long as result (or a copy of it) is held.
+        static bool fetch_result(const std::string& query, 
+                                 CassFetcher& fetcher,
+                                 CassResultPtr& result);
+        static bool fetch_result(const std::string& query, 
+                                 CassFetcher& fetcher,
+                                 CassResultPtr& result,
+                                 CassConsistency consist,
+                                 cass_duration_t timeout_in_micro = 0);
+
+        // just runs the query and hands back its result, for for_each_row
+        static bool fetch_result(const std::string& query, 
+                                 CassResultPtr& result);
+        static bool fetch_result(const std::string& query, 
+                                 CassResultPtr& result,
+                                 CassConsistency consist,
+                                 cass_duration_t timeout_in_micro = 0);
+
+        // calls func(const CassRow&) for each row of result, while it returns true.
+        // func is a template arg rather than a virtual CassFetcher::fetch, so a lambda
+        // inlines into the loop. Returns false if func did, or threw.
+        //
+        //     CassResultPtr result;
+        //     CassConn::fetch_result("select docid from other_test_data", result);
+        //     CassConn::for_each_row(result, [&](const CassRow& row) 
+        //                            {
+        //                                return FetchHelper::get_nth(0, docid, row) && ...;
+        //                            });
+        template <typename Func>
+        static bool for_each_row(const CassResultPtr& result, Func&& func)
+        {
+            bool retVal = false;
+            CassIterator* iterator = result ? cass_iterator_from_result(result.get()) : 0;
+            if (iterator)
+            {
+                retVal = true;
+                try
+                {
+                    while (retVal && cass_iterator_next(iterator))
+                    {
+                        const CassRow* row = cass_iterator_get_row(iterator);
+                        retVal = row && func(*row);
+                    }
+                } catch (std::exception& e)
+                {
+                    retVal = false;
+                    log_row_exception(e);
+                }
+                cass_iterator_free(iterator);
+            }
+            return retVal;
+        }
+
+        // fetch_result then for_each_row
+        template <typename Func>
+        static bool fetch_each(const std::string& query, Func&& func)
+        {
+            CassResultPtr result;
+            return fetch_result(query, result) && for_each_row(result, func);
+        }
+        template <typename Func>
+        static bool fetch_each(const std::string& query, 
+                               Func&& func,
+                               CassConsistency consist,
+                               cass_duration_t timeout_in_micro = 0)
+        {
+            CassResultPtr result;
+            return fetch_result(query, result, consist, timeout_in_micro) && for_each_row(result, func);
+        }
+
+        // PAGE_PREFETCH_ENUM: fetch_paged asks for the next page as soon as a page
+        //                    arrives, while that page goes through the fetcher (default)
+        // PAGE_SEQUENTIAL_ENUM: asks for the next page after the fetcher is done
+        enum PAGE_MODE_ENUM { PAGE_SEQUENTIAL_ENUM, PAGE_PREFETCH_ENUM };
+        static void set_page_mode(PAGE_MODE_ENUM mode);
+
+        // fetches page_size rows at a time and runs every page through fetcher,
+        // so only one page is in memory however many rows the query returns.
+        // Stops after max_rows rows, 0 means all of them. The timeout is per page.
+        // Goes as a text query, not through the statement cache.
+        static bool fetch_paged(const std::string& query, 
+                                CassFetcher& fetcher,
+                                unsigned page_size,
+                                uint64_t max_rows = 0);
+        static bool fetch_paged(const std::string& query, 
+                                CassFetcher& fetcher,
+                                unsigned page_size,
+                                uint64_t max_rows,
+                                CassConsistency consist,
+                                cass_duration_t timeout_in_micro = 0);
+
         // the CassFetcherHolder holds the query processing asyncronously. 
         // will have to wait when the fetcher within is accessed.
         static bool async_fetch(const std::string& query, 
@@ -121,6 +244,18 @@ namespace cb {
         static void uuid_to_string(CassUuid uuid, std::string& retVal);
         static void reset(CassInet& val);
 
+        // opt-in cache of prepared statements used by store, change and fetch with
+        // text queries. Literals in select/insert/update/delete queries are bound as 
+        // values (see CqlTemplate), so queries which only differ in their literals 
+        // share one prepared statement and skip parsing on the server.
+        // Holds at most max_entries query templates, dropping the least recently used.
+        // max_entries == 0 turns the cache off, which is the default.
+        static void set_statement_cache(size_t max_entries);
+
+        // the queue_size_io given to static_init. Keep the number of requests
+        // in flight under this, or the driver will reject them.
+        static unsigned get_queue_size_io();
+
         // escape management
         // text fields must escape a "'" with another "'" for "''"
         static void escape(std::ostream& os, const std::string& text);
@@ -130,12 +265,27 @@ namespace cb {
             uint64_t m_call = 0;     // number of successful calls
             uint64_t m_timeout = 0;  // number of local or server side timeouts
             uint64_t m_bad = 0;      // number of bad calls
+            uint64_t m_reprepare = 0;    // prepared id lost on the server, prepared again and retried
+        };
+        struct CacheStats
+        {
+            uint64_t m_hit = 0;      // query template found in the statement cache
+            uint64_t m_miss = 0;     // query template had to be prepared
+            uint64_t m_evict = 0;    // entries dropped to stay within max_entries
+        };
+        struct PageStats
+        {
+            uint64_t m_pages = 0;    // pages fetched by fetch_paged
+            uint64_t m_rows = 0;     // rows in those pages
+            uint64_t m_wait_micro = 0;   // time spent waiting on pages to arrive
         };
         struct FullStats
         {
             Stats m_fetched;
             Stats m_stored;
             Stats m_truncated;
+            CacheStats m_stmt_cache;
+            PageStats m_paged;
         };
         // call will clear the current stats
         static void get_stats(FullStats& stats);
@@ -145,14 +295,76 @@ namespace cb {
         // utility call used in CassConn::fetch as well as by CassFetcherHolder
         // for asyncronous processing
         friend class CassFetcherHolder;
+        static void log_row_exception(const std::exception& e);
+
+        // keep_result, if given, gets the result rather than it being freed
         static bool process_future(CassFuture* future, 
                                    CassFetcher& fetcher, 
                                    const std::string& query,
-                                   cass_duration_t timeout_in_micro);
+                                   cass_duration_t timeout_in_micro,
+                                   CassResultPtr* keep_result = 0);
+
+        // body of fetch and fetch_result, fetcher is null to just keep the result
+        static bool fetch(const std::string& query, 
+                          CassFetcher* fetcher,
+                          CassConsistency consist,
+                          cass_duration_t timeout_in_micro,
+                          CassResultPtr* keep_result);
+
+        // utility call used in CassConn::store as well as by StoreHolder
+        // for asyncronous processing. Does not free the future.
+        // was_unprepared, if given, is set if the server no longer knows the prepared id.
+        friend class StoreHolder;
+        static bool process_store_future(CassFuture* future, 
+                                         const std::string& query,
+                                         cass_duration_t timeout_in_micro,
+                                         bool* was_unprepared = 0);
 
         // used by PreparedStore for storing data
         friend class PreparedStore;
-        static bool store(PreparedStore& prep_store);
+        // statement is bound from prep_store and still owned by the caller.
+        // was_unprepared is set if the server no longer knows the prepared id.
+        static bool store(const PreparedStore& prep_store, 
+                          CassStatement* statement,
+                          bool& was_unprepared);
+        // same, but the store_holder picks up the result. 
+        // Also used by BulkWriter and TypedPreparedStore.
+        friend class BulkWriter;
+        template<typename... Args> friend class TypedPreparedStore;
+        static bool async_store(const PreparedStore& prep_store, 
+                                CassStatement* statement,
+                                StoreHolderPtr store_holder);
+
+        // used by BatchBuilder, takes the batch out of batch_builder
+        friend class BatchBuilder;
+        static bool store(BatchBuilder& batch_builder);
+        static bool async_store(BatchBuilder& batch_builder,
+                                StoreHolderPtr store_holder);
+
+        // used by PreparedFetch for fetching data, same args as the PreparedStore store
+        friend class PreparedFetch;
+        static bool fetch(const PreparedFetch& prep_fetch, 
+                          CassStatement* statement,
+                          CassFetcher& fetcher,
+                          bool& was_unprepared);
+        // the fetch_holder picks up the result, statement is still owned by the caller
+        static bool async_fetch(const PreparedFetch& prep_fetch, 
+                                CassStatement* statement,
+                                CassFetcherPtr fetcher,
+                                CassFetcherHolderPtr fetch_holder);
+        // new_statement binds a fresh statement for each page
+        static bool fetch_paged(const PreparedFetch& prep_fetch, 
+                                const std::function<CassStatement*()>& new_statement,
+                                CassFetcher& fetcher,
+                                unsigned page_size,
+                                uint64_t max_rows,
+                                bool& was_unprepared);
+
+        // prepares query on the server. Returns null on failure.
+        // Caller owns the result and frees it with cass_prepared_free.
+        friend class PreparedStatement;
+        static const CassPrepared* prepare(const std::string& query,
+                                           cass_duration_t timeout_in_micro);
 
 
         // default consistency
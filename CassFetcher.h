@@ -1,6 +1,7 @@
 #ifndef CB_CASS_FETCHER_H
 #define CB_CASS_FETCHER_H
 
+#include <memory>
 #include <boost/make_shared.hpp>
 #include <cassandra.h>
 
@@ -17,6 +18,12 @@ namespace cb {
 
         virtual bool fetch(const CassRow& result_row) = 0;
 
+        // called with each result (each page for fetch_paged) before its rows
+        // go through fetch. Lets a fetcher size its storage from cass_result_row_count.
+        virtual void begin_result(const CassResult& result)
+        {
+        }
+
         // virtual call filled in by derived classes. Indicates that a value was set.
         // up to derived classes to implement.
         virtual bool was_set() const
@@ -25,6 +32,10 @@ namespace cb {
         }
     };
     typedef boost::shared_ptr<CassFetcher> CassFetcherPtr;
+
+    // keeps a result alive, frees it with cass_result_free when the last copy goes.
+    // See CassConn::fetch_result.
+    typedef std::shared_ptr<const CassResult> CassResultPtr;
 }
 
 #endif 
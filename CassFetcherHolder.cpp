@@ -1,13 +1,38 @@
 #include "cql-interface/CassFetcherHolder.h"
 #include "cql-interface/CassConn.h"
+#include "cql-interface/WorkerPool.h"
 
 using namespace cb;
 
+CassFetcherHolder::~CassFetcherHolder()
+{
+    free_future();
+}
+
+void CassFetcherHolder::free_future()
+{
+    if (m_future)
+    {
+        cass_future_free(m_future);
+        m_future = 0;
+    }
+}
+
 void CassFetcherHolder::clear()
 {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    clear_locked();
+}
+
+void CassFetcherHolder::clear_locked()
+{
+    ++m_num_assigned;
+    m_callback = Callback();
+    m_executor = Executor();
     m_was_called = true;    // no need to call again
+    m_ok = false;
     m_fetcher.reset();
-    m_future = 0;
+    free_future();
     m_query.clear();
     m_timeout_in_micro = 0;
 }
@@ -17,9 +42,15 @@ bool CassFetcherHolder::assign(CassFuture* future,
                                const std::string& query,
                                cass_duration_t timeout_in_micro)
 {
+    std::lock_guard<std::mutex> guard(m_mutex);
     if (fetcher && future)
     {
+        free_future();
+        ++m_num_assigned;
+        m_callback = Callback();
+        m_executor = Executor();
         m_was_called = false;
+        m_ok = false;
         m_fetcher = fetcher;
         m_future = future;
         m_query = query;
@@ -27,27 +58,148 @@ bool CassFetcherHolder::assign(CassFuture* future,
         return true;
     } else
     {
-        clear();
+        clear_locked();
+        if (future)
+        {
+            // takes ownership either way
+            cass_future_free(future);
+        }
     }
     return false;
 }
 
-CassFetcherPtr CassFetcherHolder::get_fetcher()
+void CassFetcherHolder::process()
 {
     if (m_future && m_fetcher && !m_was_called)
     {
         m_was_called = true;
-        CassConn::process_future(m_future, *m_fetcher, m_query, m_timeout_in_micro);
+        m_ok = CassConn::process_future(m_future, *m_fetcher, m_query, m_timeout_in_micro);
+        m_future = 0;       // freed by process_future
     }
+}
+
+CassFetcherPtr CassFetcherHolder::get_fetcher()
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    process();
     return m_fetcher;
 }
 
 bool CassFetcherHolder::was_set()
 {
-    if (m_future && m_fetcher && !m_was_called)
+    std::lock_guard<std::mutex> guard(m_mutex);
+    process();
+    return (m_fetcher ? m_fetcher->was_set() : false);
+}
+
+bool CassFetcherHolder::wait()
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    process();
+    return m_ok;
+}
+
+bool CassFetcherHolder::is_ready() const
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    return !m_future || m_was_called || cass_future_ready(m_future);
+}
+
+bool CassFetcherHolder::on_complete(Callback callback, Executor executor)
+{
+    CassFuture* future = 0;
+    uint64_t num_assigned = 0;
     {
-        m_was_called = true;
-        CassConn::process_future(m_future, *m_fetcher, m_query, m_timeout_in_micro);
+        std::lock_guard<std::mutex> guard(m_mutex);
+        if (m_future && m_fetcher && !m_was_called)
+        {
+            m_callback = callback;
+            m_executor = executor;
+            future = m_future;
+            num_assigned = m_num_assigned;
+        }
+    }
+    if (!future)
+    {
+        // nothing in flight, so report what we have
+        CassFetcherHolderPtr self = shared_from_this();
+        auto task = [self, callback]()
+        {
+            bool ok = self->wait();
+            callback(ok, self->get_fetcher());
+        };
+        if (executor)
+        {
+            executor(task);
+        } else
+        {
+            task();
+        }
+        return true;
+    }
+
+    // the driver holds a reference to this until complete is called.
+    // If the future is already done the driver calls complete right away,
+    // so do this without the lock.
+    Pending* pending = new Pending{shared_from_this(), num_assigned};
+    if (cass_future_set_callback(future, &CassFetcherHolder::complete, pending) != CASS_OK)
+    {
+        delete pending;
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_callback = Callback();
+        m_executor = Executor();
+        return false;
+    }
+    return true;
+}
+
+bool CassFetcherHolder::on_complete(Callback callback, WorkerPool& pool)
+{
+    return on_complete(callback, [&pool](std::function<void()> task) { pool.post(task); });
+}
+
+void CassFetcherHolder::complete(CassFuture* future, void* data)
+{
+    Pending* pending = static_cast<Pending*>(data);
+    CassFetcherHolderPtr self;
+    self.swap(pending->m_holder);
+    uint64_t num_assigned = pending->m_num_assigned;
+    delete pending;
+
+    Executor executor;
+    {
+        std::lock_guard<std::mutex> guard(self->m_mutex);
+        executor = self->m_executor;
+    }
+    if (executor)
+    {
+        executor([self, num_assigned]() { self->finish(num_assigned); });
+    } else
+    {
+        self->finish(num_assigned);
+    }
+}
+
+void CassFetcherHolder::finish(uint64_t num_assigned)
+{
+    Callback callback;
+    bool ok = false;
+    CassFetcherPtr fetcher;
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        // skip it if the holder was cleared or given another fetch since
+        if (m_num_assigned == num_assigned)
+        {
+            // the result is in, so process_future does not wait
+            process();
+            ok = m_ok;
+            fetcher = m_fetcher;
+            callback.swap(m_callback);
+            m_executor = Executor();
+        }
+    }
+    if (callback)
+    {
+        callback(ok, fetcher);
     }
-    return (m_fetcher ? m_fetcher->was_set() : false);
 }
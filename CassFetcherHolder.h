@@ -1,26 +1,37 @@
 #ifndef CB_CASS_FETCHER_HOLDER_H
 #define CB_CASS_FETCHER_HOLDER_H
 
+#include <functional>
+#include <mutex>
+#include <boost/enable_shared_from_this.hpp>
 #include "cql-interface/CassFetcher.h"
 
 namespace cb {
 
+    class WorkerPool;
+
     // holds CassFetcher in a asyn fetch context.
-    // Can be used to set aside a query and pick it up asyncronously.
-    class CassFetcherHolder
+    // Can be used to set aside a query and pick it up asyncronously,
+    // or given a callback with on_complete so no thread waits on it.
+    class CassFetcherHolder : public boost::enable_shared_from_this<CassFetcherHolder>
     {
     public:
 
+        // called with whether the fetch worked (even if it found no rows) 
+        // and the fetcher holding the rows
+        typedef std::function<void(bool, CassFetcherPtr)> Callback;
+
+        // runs a task somewhere else, e.g. posts it to an event loop
+        typedef std::function<void(std::function<void()>)> Executor;
+
         CassFetcherHolder()
         {
             clear();
         }
 
-        ~CassFetcherHolder() 
-        {
-        }
+        ~CassFetcherHolder();
 
-        // set this Holder with some contents
+        // set this Holder with some contents. Takes ownership of the future.
         bool assign(CassFuture* future, 
                     CassFetcherPtr fetcher,
                     const std::string& query,
@@ -35,6 +46,22 @@ namespace cb {
         // fetcher where the fetcher does not hold values you need.
         bool was_set();
 
+        // will wait for the future like get_fetcher, returns true if the fetch
+        // worked, even if it found no rows.
+        bool wait();
+
+        // true once the result is in, so get_fetcher or wait will not block
+        bool is_ready() const;
+
+        // callback is called once the result is in, or right away if it already
+        // has been picked up. Holds a reference to this until then.
+        // Without an executor the rows go through the fetcher and the callback
+        // runs on the driver thread, so keep both short. With one, the driver thread
+        // only hands executor a task to do both.
+        bool on_complete(Callback callback, Executor executor = Executor());
+        // same, with the task posted to pool
+        bool on_complete(Callback callback, WorkerPool& pool);
+
         // clears out current contents
         void clear();
     private:
@@ -44,12 +71,38 @@ namespace cb {
         CassFetcherHolder(const CassFetcherHolder&) = delete;
         CassFetcherHolder& operator=(const CassFetcherHolder&) = delete;
 
+        // runs process_future the first time only. Must hold m_mutex
+        void process();
+
+        // must hold m_mutex
+        void clear_locked();
+        void free_future();
+
+        // what the driver holds on to for complete
+        struct Pending
+        {
+            boost::shared_ptr<CassFetcherHolder> m_holder;
+            uint64_t m_num_assigned;
+        };
+
+        // processes the result and calls the callback, unless the holder
+        // was cleared or assigned again after on_complete
+        void finish(uint64_t num_assigned);
+
+        static void complete(CassFuture* future, void* data);
+
+        mutable std::mutex m_mutex;
+        Callback m_callback;
+        Executor m_executor;
+        uint64_t m_num_assigned = 0;    // bumped by every assign and clear
+
         CassFetcherPtr m_fetcher;
-        CassFuture* m_future;
+        CassFuture* m_future = 0;
         std::string m_query;
         cass_duration_t m_timeout_in_micro;
 
         bool m_was_called;
+        bool m_ok;
     };
     typedef boost::shared_ptr<CassFetcherHolder> CassFetcherHolderPtr;
 }
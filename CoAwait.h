@@ -0,0 +1,290 @@
+#ifndef CB_CO_AWAIT_H
+#define CB_CO_AWAIT_H
+
+// co_await-able fetches and stores, for C++20 (build with -DUSE_CXX20=1).
+// Empty with older standards.
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+
+#include <atomic>
+#include <coroutine>
+#include <string>
+#include <boost/make_shared.hpp>
+#include "cql-interface/CassConn.h"
+#include "cql-interface/ConFetcherAsync.h"
+#include "cql-interface/FetcherAsync.h"
+#include "cql-interface/PreparedFetch.h"
+#include "cql-interface/PreparedStore.h"
+#include "cql-interface/StoreHolder.h"
+#include "cql-interface/WorkerPool.h"
+
+namespace cb {
+
+    // base of FetchAwaitable and StoreAwaitable. The coroutine is resumed from the
+    // driver's future callback, so no thread waits on the query. By default it
+    // resumes on the driver thread which completed the future; with resume_on it
+    // resumes on an executor or WorkerPool instead, which is better for anything
+    // more than a little work after the co_await.
+    //
+    // co_await them where they are made; they can only be moved before that.
+    class CoAwaitable
+    {
+    public:
+
+        typedef CassFetcherHolder::Executor Executor;
+
+        bool await_ready() const
+        {
+            return !m_started;
+        }
+
+    protected:
+
+        explicit CoAwaitable(bool started)
+        : m_started(started)
+        {
+        }
+
+        // nothing is in flight on this yet, so there is no state to move
+        CoAwaitable(CoAwaitable&& other)
+        : m_executor(std::move(other.m_executor)),
+          m_started(other.m_started)
+        {
+        }
+
+        CoAwaitable& operator=(const CoAwaitable&) = delete;
+
+        // called by await_suspend once the callback is set up. Either this or
+        // done comes second, and that one resumes. Returns false if done came
+        // first, so the coroutine just carries on.
+        bool suspend()
+        {
+            return m_state.exchange(SUSPENDED_ENUM) != DONE_ENUM;
+        }
+
+        // called from the callback, after setting m_ok
+        void done()
+        {
+            if (m_state.exchange(DONE_ENUM) == SUSPENDED_ENUM)
+            {
+                m_handle.resume();
+            }
+        }
+
+        enum STATE_ENUM { START_ENUM, SUSPENDED_ENUM, DONE_ENUM };
+
+        std::coroutine_handle<> m_handle;
+        std::atomic<int> m_state{START_ENUM};
+        Executor m_executor;
+        bool m_started;
+        bool m_ok = false;
+    };
+
+    // co_await gives true if the fetch worked, like CassFetcherHolder::wait.
+    // From co_fetch_value, only if a value was found, like Fetcher::do_fetch.
+    class FetchAwaitable : public CoAwaitable
+    {
+    public:
+
+        FetchAwaitable(CassFetcherPtr fetcher, CassFetcherHolderPtr holder, bool started, bool need_set = false)
+        : CoAwaitable(started),
+          m_fetcher(fetcher),
+          m_holder(holder),
+          m_need_set(need_set)
+        {
+        }
+
+        // rows go through the fetcher on the executor as well
+        FetchAwaitable resume_on(Executor executor) &&
+        {
+            m_executor = executor;
+            return std::move(*this);
+        }
+        FetchAwaitable resume_on(WorkerPool& pool) &&
+        {
+            m_executor = [&pool](std::function<void()> task) { pool.post(task); };
+            return std::move(*this);
+        }
+
+        bool await_suspend(std::coroutine_handle<> handle)
+        {
+            m_handle = handle;
+            if (!m_holder->on_complete([this](bool ok, CassFetcherPtr fetcher)
+                                       {
+                                           m_ok = ok && (!m_need_set || fetcher->was_set());
+                                           done();
+                                       },
+                                       m_executor))
+            {
+                return false;
+            }
+            return suspend();
+        }
+
+        bool await_resume() const
+        {
+            return m_ok;
+        }
+
+    private:
+
+        CassFetcherPtr m_fetcher;
+        CassFetcherHolderPtr m_holder;
+        bool m_need_set;
+    };
+
+    // co_await gives true if the store worked, like StoreHolder::wait
+    class StoreAwaitable : public CoAwaitable
+    {
+    public:
+
+        StoreAwaitable(StoreHolderPtr holder, bool started)
+        : CoAwaitable(started),
+          m_holder(holder)
+        {
+        }
+
+        StoreAwaitable resume_on(Executor executor) &&
+        {
+            m_executor = executor;
+            return std::move(*this);
+        }
+        StoreAwaitable resume_on(WorkerPool& pool) &&
+        {
+            m_executor = [&pool](std::function<void()> task) { pool.post(task); };
+            return std::move(*this);
+        }
+
+        bool await_suspend(std::coroutine_handle<> handle)
+        {
+            m_handle = handle;
+            if (!m_holder->on_complete([this](bool ok)
+                                       {
+                                           m_ok = ok;
+                                           if (m_executor)
+                                           {
+                                               m_executor([this]() { done(); });
+                                           } else
+                                           {
+                                               done();
+                                           }
+                                       }))
+            {
+                return false;
+            }
+            return suspend();
+        }
+
+        bool await_resume() const
+        {
+            return m_ok;
+        }
+
+        // see StoreHolder::was_unprepared, for co_store of a PreparedStore:
+        //
+        //     StoreAwaitable store = co_store(*prep_store, docid, value);
+        //     if (!co_await store && store.was_unprepared() && prep_store->reprepare())
+        //         ...     // co_store again
+        bool was_unprepared() const
+        {
+            return m_holder->was_unprepared();
+        }
+
+    private:
+
+        StoreHolderPtr m_holder;
+    };
+
+    // fetch into any CassFetcher, from a coroutine:
+    //
+    //     boost::shared_ptr<MyFetcher> fetcher = boost::make_shared<MyFetcher>();
+    //     if (co_await co_fetch("select docid, value from other_test_data", fetcher).resume_on(pool))
+    //     ...
+    inline FetchAwaitable co_fetch(const std::string& query, CassFetcherPtr fetcher)
+    {
+        CassFetcherHolderPtr holder = boost::make_shared<CassFetcherHolder>();
+        bool started = CassConn::async_fetch(query, fetcher, holder);
+        return FetchAwaitable(fetcher, holder, started);
+    }
+    inline FetchAwaitable co_fetch(const std::string& query,
+                                   CassFetcherPtr fetcher,
+                                   CassConsistency consist,
+                                   cass_duration_t timeout_in_micro = 0)
+    {
+        CassFetcherHolderPtr holder = boost::make_shared<CassFetcherHolder>();
+        bool started = CassConn::async_fetch(query, fetcher, holder, consist, timeout_in_micro);
+        return FetchAwaitable(fetcher, holder, started);
+    }
+
+    // with a prepared select, binding Fargs. Will throw if there is an issue binding values.
+    template<typename... Targs>
+    FetchAwaitable co_fetch(PreparedFetch& prep_fetch, CassFetcherPtr fetcher, const Targs&... Fargs)
+    {
+        CassFetcherHolderPtr holder = boost::make_shared<CassFetcherHolder>();
+        bool started = prep_fetch.async_fetch(fetcher, holder, Fargs...);
+        return FetchAwaitable(fetcher, holder, started);
+    }
+
+    // the Fetcher of a coroutine, gives true if val was set
+    template <typename T>
+    FetchAwaitable co_fetch_value(const std::string& query, T& val)
+    {
+        CassFetcherPtr fetcher = boost::make_shared<FetcherAsync<T>>(query, val);
+        CassFetcherHolderPtr holder = boost::make_shared<CassFetcherHolder>();
+        bool started = CassConn::async_fetch(query, fetcher, holder);
+        return FetchAwaitable(fetcher, holder, started, true);
+    }
+    template <typename T, typename... Targs>
+    FetchAwaitable co_fetch_value(PreparedFetch& prep_fetch, T& val, const Targs&... Fargs)
+    {
+        CassFetcherPtr fetcher = boost::make_shared<FetcherAsync<T>>(prep_fetch.query(), val);
+        CassFetcherHolderPtr holder = boost::make_shared<CassFetcherHolder>();
+        bool started = prep_fetch.async_fetch(fetcher, holder, Fargs...);
+        return FetchAwaitable(fetcher, holder, started, true);
+    }
+
+    // the ConFetcher of a coroutine, con gets a T per row
+    template <typename T, typename Con>
+    FetchAwaitable co_fetch_con(const std::string& query, Con& con)
+    {
+        CassFetcherPtr fetcher = boost::make_shared<ConFetcherAsync<T,Con>>(query, con);
+        CassFetcherHolderPtr holder = boost::make_shared<CassFetcherHolder>();
+        bool started = CassConn::async_fetch(query, fetcher, holder);
+        return FetchAwaitable(fetcher, holder, started);
+    }
+    template <typename T, typename Con, typename... Targs>
+    FetchAwaitable co_fetch_con(PreparedFetch& prep_fetch, Con& con, const Targs&... Fargs)
+    {
+        CassFetcherPtr fetcher = boost::make_shared<ConFetcherAsync<T,Con>>(prep_fetch.query(), con);
+        CassFetcherHolderPtr holder = boost::make_shared<CassFetcherHolder>();
+        bool started = prep_fetch.async_fetch(fetcher, holder, Fargs...);
+        return FetchAwaitable(fetcher, holder, started);
+    }
+
+    inline StoreAwaitable co_store(const std::string& query)
+    {
+        StoreHolderPtr holder = boost::make_shared<StoreHolder>();
+        bool started = CassConn::async_store(query, holder);
+        return StoreAwaitable(holder, started);
+    }
+    inline StoreAwaitable co_store(const std::string& query,
+                                   CassConsistency consist,
+                                   cass_duration_t timeout_in_micro = 0)
+    {
+        StoreHolderPtr holder = boost::make_shared<StoreHolder>();
+        bool started = CassConn::async_store(query, holder, consist, timeout_in_micro);
+        return StoreAwaitable(holder, started);
+    }
+
+    // a prepared store, binding Fargs. Will throw if there is an issue binding values.
+    template<typename... Targs>
+    StoreAwaitable co_store(PreparedStore& prep_store, const Targs&... Fargs)
+    {
+        StoreHolderPtr holder = boost::make_shared<StoreHolder>();
+        bool started = prep_store.async_store(holder, Fargs...);
+        return StoreAwaitable(holder, started);
+    }
+}
+
+#endif
+
+#endif
@@ -0,0 +1,49 @@
+#include <cstring>
+#include "log4cxx/logger.h"
+
+#include "cql-interface/ColumnIndex.h"
+
+using namespace cb;
+using namespace std;
+
+namespace {
+    log4cxx::LoggerPtr logger(log4cxx::Logger::getLogger("cb.column_index"));
+}
+
+ColumnIndex::ColumnIndex(std::initializer_list<std::string> names)
+: m_names(names),
+  m_index(m_names.size(), -1)
+{
+}
+
+ColumnIndex::ColumnIndex(const std::vector<std::string>& names)
+: m_names(names),
+  m_index(m_names.size(), -1)
+{
+}
+
+bool ColumnIndex::resolve(const CassResult& result)
+{
+    bool retVal = true;
+    size_t num_columns = cass_result_column_count(&result);
+    for (size_t i = 0; i < m_names.size(); ++i)
+    {
+        const string& name = m_names[i];
+        m_index[i] = -1;
+        for (size_t field = 0; field < num_columns; ++field)
+        {
+            CassString column = cass_result_column_name(&result, field);
+            if (column.length == name.size() && !memcmp(column.data, name.data(), column.length))
+            {
+                m_index[i] = int(field);
+                break;
+            }
+        }
+        if (m_index[i] < 0)
+        {
+            LOG4CXX_ERROR(logger, "column \"" << name << "\" is not in the result");
+            retVal = false;
+        }
+    }
+    return retVal;
+}
@@ -0,0 +1,90 @@
+#ifndef CB_COLUMN_INDEX_H
+#define CB_COLUMN_INDEX_H
+
+#include <initializer_list>
+#include <string>
+#include <vector>
+#include "cql-interface/FetchHelper.h"
+
+namespace cb {
+
+    // gets columns by name rather than by position, so a fetcher still works
+    // when the select list is reordered. The names are looked up in the
+    // result column metadata once per result, in begin_result, and every
+    // row after that reads by position:
+    //
+    //     class DocFetcher : public CassFetcher
+    //     {
+    //         ColumnIndex m_cols = {"docid", "value"};
+    //
+    //         virtual void begin_result(const CassResult& result)
+    //         {
+    //             m_cols.resolve(result);
+    //         }
+    //         virtual bool fetch(const CassRow& row)
+    //         {
+    //             return m_cols.get_columns(row, docid, value);
+    //         }
+    //     };
+    //
+    // Names match the result metadata exactly, so lower case unless the column was quoted.
+    class ColumnIndex
+    {
+    public:
+
+        ColumnIndex(std::initializer_list<std::string> names);
+        explicit ColumnIndex(const std::vector<std::string>& names);
+
+        // finds the position of each name in result. Returns false, and logs,
+        // if any name is not in the result; those columns then fail to get.
+        bool resolve(const CassResult& result);
+
+        // position in the row of the i-th name, -1 if not found
+        int index(size_t i) const
+        {
+            return m_index[i];
+        }
+
+        const std::vector<std::string>& names() const
+        {
+            return m_names;
+        }
+
+        // same as FetchHelper::get_nth on the column of the i-th name
+        template <typename T>
+        bool get(size_t i, 
+                 T& val, 
+                 const CassRow& row,
+                 cass_fld_required_enum_t req_opt = CASS_FLD_IS_REQUIRED_ENUM) const
+        {
+            int field = m_index[i];
+            return field >= 0 && FetchHelper::get_nth(field, val, row, req_opt);
+        }
+
+        // the i-th name goes into the i-th val
+        template <typename... Ts>
+        bool get_columns(const CassRow& row, Ts&... vals) const
+        {
+            return get_columns_from(0, row, vals...);
+        }
+
+    private:
+
+        bool get_columns_from(size_t i, const CassRow& row) const
+        {
+            return true;
+        }
+
+        template <typename T, typename... Ts>
+        bool get_columns_from(size_t i, const CassRow& row, T& val, Ts&... vals) const
+        {
+            return get(i, val, row) && get_columns_from(i + 1, row, vals...);
+        }
+
+        std::vector<std::string> m_names;
+        std::vector<int> m_index;
+    };
+}
+
+#endif 
+
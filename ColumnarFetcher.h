@@ -0,0 +1,240 @@
+#ifndef CB_COLUMNAR_FETCHER_H
+#define CB_COLUMNAR_FETCHER_H
+
+#include <stdint.h>
+#include <algorithm>
+#include <tuple>
+#include <vector>
+#include "cql-interface/FetchHelper.h"
+#include "cql-interface/CassConn.h"
+#include "cql-interface/PreparedFetch.h"
+
+namespace cb {
+
+    // one column of a ColumnarFetcher. Null values are kept as T() in values,
+    // with their bit set in the null bitmap.
+    template <typename T>
+    class FetchColumn
+    {
+    public:
+
+        const std::vector<T>& values() const
+        {
+            return m_values;
+        }
+
+        size_t size() const
+        {
+            return m_values.size();
+        }
+
+        bool is_null(size_t i) const
+        {
+            return (m_nulls[i / 64] >> (i % 64)) & 1;
+        }
+
+        bool has_nulls() const
+        {
+            return m_num_nulls != 0;
+        }
+
+        void clear()
+        {
+            m_values.clear();
+            m_nulls.clear();
+            m_num_nulls = 0;
+        }
+
+    protected:
+
+        template <typename... Ts> friend class ColumnarFetcher;
+
+        // room for nrows more, grows at least 2x so paged results don't copy per page
+        void reserve_more(size_t nrows)
+        {
+            size_t want = m_values.size() + nrows;
+            if (want > m_values.capacity())
+            {
+                want = std::max(want, 2 * m_values.capacity());
+                m_values.reserve(want);
+                m_nulls.reserve(want / 64 + 1);
+            }
+        }
+
+        // adds nothing if the value does not decode. Decodes into a local, since
+        // m_values.back() is only a proxy for vector<bool>.
+        bool add(int field, const CassRow& row)
+        {
+            const CassValue* cass_value = cass_row_get_column(&row, field);
+            if (cass_value_is_null(cass_value))
+            {
+                push_back(T(), true);
+                return true;
+            }
+            T val = T();
+            if (!FetchHelper::get_value(val, cass_value))
+            {
+                return false;
+            }
+            push_back(std::move(val), false);
+            return true;
+        }
+
+        void push_back(T&& val, bool is_null)
+        {
+            size_t i = m_values.size();
+            if (i % 64 == 0)
+            {
+                m_nulls.push_back(0);
+            }
+            m_values.push_back(std::move(val));
+            if (is_null)
+            {
+                m_nulls.back() |= uint64_t(1) << (i % 64);
+                ++m_num_nulls;
+            }
+        }
+
+        // drops the last value, after one of the columns failed on it
+        void pop_back()
+        {
+            size_t i = m_values.size() - 1;
+            if (is_null(i))
+            {
+                --m_num_nulls;
+            }
+            m_values.pop_back();
+            if (i % 64 == 0)
+            {
+                m_nulls.pop_back();
+            } else
+            {
+                m_nulls.back() &= ~(uint64_t(1) << (i % 64));
+            }
+        }
+
+        std::vector<T> m_values;
+        std::vector<uint64_t> m_nulls;
+        size_t m_num_nulls = 0;
+    };
+
+    // decodes column i of each row into its own contiguous vector,
+    // column<i>().values(), rather than a vector of row objects.
+    // Loops over one column then run over plain arrays, which the compiler can vectorize:
+    //
+    //     ColumnarFetcher<cass_int32_t, cass_double_t> fetcher;
+    //     fetcher.do_fetch("select int_value, double_value from prep_store");
+    //     const std::vector<cass_double_t>& vals = fetcher.column<1>().values();
+    //
+    // Each result is reserved from cass_result_row_count up front. Works with
+    // CassConn::fetch_paged too, the pages are appended.
+    template <typename... Ts>
+    class ColumnarFetcher : public CassFetcher
+    {
+    public:
+
+        virtual ~ColumnarFetcher() {}
+
+        bool do_fetch(const std::string& query)
+        {
+            clear();
+            return CassConn::fetch(query, *this);
+        }
+
+        // if timeout_in_micro == 0, will use global timeout default set in CassConn
+        bool do_fetch(const std::string& query,
+                      CassConsistency consist,
+                      cass_duration_t timeout_in_micro = 0)
+        {
+            clear();
+            return CassConn::fetch(query, *this, consist, timeout_in_micro);
+        }
+
+        // fetch with a prepared select, binding Fargs.
+        // will throw if there is an issue binding values.
+        template<typename... Targs>
+        bool do_fetch(PreparedFetch& prep_fetch, const Targs&... Fargs)
+        {
+            clear();
+            return prep_fetch.fetch(*this, Fargs...);
+        }
+
+        template <size_t I>
+        const FetchColumn<typename std::tuple_element<I, std::tuple<Ts...>>::type>& column() const
+        {
+            return std::get<I>(m_columns);
+        }
+
+        // number of rows
+        size_t size() const
+        {
+            return std::get<0>(m_columns).size();
+        }
+
+        void clear()
+        {
+            for_each<0>(ClearOp());
+        }
+
+    protected:
+
+        virtual void begin_result(const CassResult& result)
+        {
+            for_each<0>(ReserveOp{cass_result_row_count(&result)});
+        }
+
+        virtual bool fetch(const CassRow& row)
+        {
+            return add<0>(row);
+        }
+
+        struct ClearOp
+        {
+            template <typename T> void operator()(FetchColumn<T>& col) const { col.clear(); }
+        };
+        struct ReserveOp
+        {
+            size_t m_nrows;
+            template <typename T> void operator()(FetchColumn<T>& col) const { col.reserve_more(m_nrows); }
+        };
+
+        template <size_t I, typename Op>
+        typename std::enable_if<I == sizeof...(Ts)>::type for_each(const Op& op)
+        {
+        }
+
+        template <size_t I, typename Op>
+        typename std::enable_if<I < sizeof...(Ts)>::type for_each(const Op& op)
+        {
+            op(std::get<I>(m_columns));
+            for_each<I + 1>(op);
+        }
+
+        template <size_t I>
+        typename std::enable_if<I == sizeof...(Ts), bool>::type add(const CassRow& row)
+        {
+            return true;
+        }
+
+        // every column gets the row or none do, so the columns stay the same length
+        template <size_t I>
+        typename std::enable_if<I < sizeof...(Ts), bool>::type add(const CassRow& row)
+        {
+            if (!std::get<I>(m_columns).add(I, row))
+            {
+                return false;
+            }
+            if (add<I + 1>(row))
+            {
+                return true;
+            }
+            std::get<I>(m_columns).pop_back();
+            return false;
+        }
+
+        std::tuple<FetchColumn<Ts>...> m_columns;
+    };
+}
+
+#endif
+
@@ -1,19 +1,31 @@
 #ifndef CB_CON_FETCHER_H
 #define CB_CON_FETCHER_H
 
+#include <algorithm>
+#include <deque>
+#include <vector>
 #include "cql-interface/FetchHelper.h"
+#include "cql-interface/ConInsertTraits.h"
 #include "cql-interface/CassConn.h"
+#include "cql-interface/PreparedFetch.h"
 
 namespace cb {
 
     // fetch multiple value result, must be known to FetchHelper
-    // note this container must work with push_back. If using a set, need to make a new template.
+    // values go into con through ConInsertTraits, so with push_back or insert, and
+    // con is reserved from the result row count when it has reserve. 
+    // With T a std::pair, each row is a select of key and value, for maps.
     // returns true if value obtained, otherwise false
     template <typename T, typename Con>
     class ConFetcher : public CassFetcher
     {
     public:
 
+        ConFetcher()
+        : m_conPtr(0)
+        {
+        }
+
         virtual ~ConFetcher() {}
 
         bool do_fetch(const std::string& query, Con& con)
@@ -34,19 +46,155 @@ namespace cb {
             return CassConn::fetch(query, *this, consist, timeout_in_micro);
         }
 
+        // fetch with a prepared select, binding Fargs. 
+        // will throw if there is an issue binding values.
+        template<typename... Targs>
+        bool do_fetch(PreparedFetch& prep_fetch, Con& con, const Targs&... Fargs)
+        {
+            con.clear();
+            m_conPtr = &con;
+            return prep_fetch.fetch(*this, Fargs...);
+        }
+
+        // point lookup of every key in keys with prep_fetch, which takes the key as its
+        // only bound value. Rather than one "where docid in (...)" select, each key
+        // goes as its own select, so each goes straight to its replicas and one slow
+        // replica does not hold up the rest. Up to max_in_flight selects are out at
+        // once, 0 means half of CassConn::get_queue_size_io.
+        // Rows are added to con in the order of keys. key_ok gets one entry per key,
+        // true if its select worked (even with no rows).
+        // Returns true if every select worked.
+        template<typename Keys>
+        bool multi_get(PreparedFetch& prep_fetch, 
+                       Con& con, 
+                       const Keys& keys, 
+                       std::vector<bool>& key_ok,
+                       unsigned max_in_flight = 0)
+        {
+            con.clear();
+            key_ok.assign(keys.size(), false);
+            if (!max_in_flight)
+            {
+                max_in_flight = std::max(CassConn::get_queue_size_io() / 2, 1u);
+            }
+
+            bool retVal = true;
+            size_t next_ok = 0;
+            std::deque<KeyGet> pending;
+            try
+            {
+                for (auto it = keys.begin(); it != keys.end(); ++it)
+                {
+                    if (pending.size() >= max_in_flight)
+                    {
+                        retVal = reap(pending, con, key_ok, next_ok) && retVal;
+                    }
+                    pending.push_back(KeyGet());
+                    KeyGet& get = pending.back();
+                    get.m_fetcher = boost::make_shared<KeyFetcher>();
+                    get.m_holder = boost::make_shared<CassFetcherHolder>();
+                    prep_fetch.async_fetch(get.m_fetcher, get.m_holder, *it);
+                }
+                while (!pending.empty())
+                {
+                    retVal = reap(pending, con, key_ok, next_ok) && retVal;
+                }
+            } catch (...)
+            {
+                drain(pending);
+                throw;
+            }
+            return retVal;
+        }
+
     protected:
 
+        virtual void begin_result(const CassResult& result)
+        {
+            if (m_conPtr)
+            {
+                ConInsertTraits<Con>::reserve_more(*m_conPtr, cass_result_row_count(&result));
+            }
+        }
+
         virtual bool fetch(const CassRow& result)
         {
-            if (FetchHelper::get_first(m_tmp, result))
+            if (FetchHelper::get_entry(m_tmp, result))
             {
-                m_conPtr->push_back(m_tmp);
+                ConInsertTraits<Con>::insert(*m_conPtr, std::move(m_tmp));
                 return true;
             }
             return false;
         }
         Con* m_conPtr;
         T m_tmp;
+
+    private:
+
+        // rows for one key of multi_get
+        class KeyFetcher : public CassFetcher
+        {
+        public:
+
+            virtual void begin_result(const CassResult& result)
+            {
+                ConInsertTraits<Con>::reserve_more(m_con, cass_result_row_count(&result));
+            }
+
+            virtual bool fetch(const CassRow& result)
+            {
+                if (FetchHelper::get_entry(m_tmp, result))
+                {
+                    ConInsertTraits<Con>::insert(m_con, std::move(m_tmp));
+                    return true;
+                }
+                return false;
+            }
+            Con m_con;
+            T m_tmp;
+        };
+
+        struct KeyGet
+        {
+            boost::shared_ptr<KeyFetcher> m_fetcher;
+            CassFetcherHolderPtr m_holder;
+        };
+
+        // waits on the oldest key, so rows go into con in key order
+        bool reap(std::deque<KeyGet>& pending, Con& con, std::vector<bool>& key_ok, size_t& next_ok)
+        {
+            KeyGet& get = pending.front();
+            bool retVal = get.m_holder->wait();
+            if (retVal)
+            {
+                Con& key_con = get.m_fetcher->m_con;
+                ConInsertTraits<Con>::reserve_more(con, key_con.size());
+                for (auto it = key_con.begin(); it != key_con.end(); ++it)
+                {
+                    ConInsertTraits<Con>::insert(con, std::move(*it));
+                }
+            }
+            key_ok[next_ok++] = retVal;
+            pending.pop_front();
+            return retVal;
+        }
+
+        // a holder only frees its future once waited on, so wait out what is
+        // still in flight before multi_get throws
+        static void drain(std::deque<KeyGet>& pending)
+        {
+            for (auto it = pending.begin(); it != pending.end(); ++it)
+            {
+                try
+                {
+                    it->m_holder->wait();
+                } catch (...)
+                {
+                    // already throwing, keep going so the rest are freed
+                }
+            }
+            pending.clear();
+        }
     };
 
 }
@@ -2,12 +2,13 @@
 #define CB_CON_FETCHER_ASYNC_H
 
 #include "cql-interface/FetchHelper.h"
+#include "cql-interface/ConInsertTraits.h"
 #include "cql-interface/CassConn.h"
 
 namespace cb {
 
     // fetch multiple value result, must be known to FetchHelper
-    // note this container must work with push_back. If using a set, need to make a new template.
+    // con is filled through ConInsertTraits, the same as ConFetcher.
     template <typename T, typename Con>
     class ConFetcherAsync : public CassFetcher
     {
@@ -29,12 +30,17 @@ namespace cb {
 
     protected:
 
+        virtual void begin_result(const CassResult& result)
+        {
+            ConInsertTraits<Con>::reserve_more(*m_conPtr, cass_result_row_count(&result));
+        }
+
         virtual bool fetch(const CassRow& result)
         {
-            if (FetchHelper::get_first(m_tmp, result))
+            if (FetchHelper::get_entry(m_tmp, result))
             {
                 m_was_set = true;
-                m_conPtr->push_back(m_tmp);
+                ConInsertTraits<Con>::insert(*m_conPtr, std::move(m_tmp));
                 return true;
             }
             return false;
@@ -0,0 +1,71 @@
+#ifndef CB_CON_INSERT_TRAITS_H
+#define CB_CON_INSERT_TRAITS_H
+
+#include <algorithm>
+#include <utility>
+
+namespace cb {
+
+    namespace con_insert_detail {
+
+        // grow like push_back would, so a reserve per page doesn't copy per page
+        template <typename Con>
+        auto reserve_more(Con& con, size_t extra, int) 
+                -> decltype(con.capacity(), con.reserve(extra), void())
+        {
+            size_t want = con.size() + extra;
+            if (want > con.capacity())
+            {
+                con.reserve(std::max(want, 2 * con.capacity()));
+            }
+        }
+
+        // unordered containers
+        template <typename Con>
+        auto reserve_more(Con& con, size_t extra, long) 
+                -> decltype(con.reserve(extra), void())
+        {
+            con.reserve(con.size() + extra);
+        }
+
+        template <typename Con>
+        void reserve_more(Con& con, size_t extra, ...)
+        {
+        }
+
+        template <typename Con, typename T>
+        auto insert(Con& con, T&& val, int) 
+                -> decltype(con.push_back(std::forward<T>(val)), void())
+        {
+            con.push_back(std::forward<T>(val));
+        }
+
+        template <typename Con, typename T>
+        void insert(Con& con, T&& val, long)
+        {
+            con.insert(std::forward<T>(val));
+        }
+    }
+
+    // how ConFetcher and ConFetcherAsync fill a container. By default values
+    // go in with push_back if Con has it, otherwise with insert, so sets and
+    // maps work as well as vectors and lists. Room for a result is reserved if
+    // Con has reserve. Specialize this for containers with another interface.
+    template <typename Con>
+    struct ConInsertTraits
+    {
+        static void reserve_more(Con& con, size_t extra)
+        {
+            con_insert_detail::reserve_more(con, extra, 0);
+        }
+
+        template <typename T>
+        static void insert(Con& con, T&& val)
+        {
+            con_insert_detail::insert(con, std::forward<T>(val), 0);
+        }
+    };
+}
+
+#endif 
+
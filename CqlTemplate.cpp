@@ -0,0 +1,259 @@
+#include <cstdlib>
+#include <boost/algorithm/string.hpp>
+
+#include "cql-interface/CqlTemplate.h"
+
+using namespace cb;
+using namespace std;
+
+namespace {
+
+    bool is_ident_char(char c)
+    {
+        return isalnum(static_cast<unsigned char>(c)) || c == '_';
+    }
+
+    bool is_hex_char(char c)
+    {
+        return isxdigit(static_cast<unsigned char>(c));
+    }
+}
+
+bool CqlTemplate::parse(const std::string& query)
+{
+    m_text.clear();
+    m_key.clear();
+    m_literals.clear();
+
+    size_t pos = query.find_first_not_of(" \t\r\n");
+    if (pos == string::npos)
+    {
+        return false;
+    }
+    size_t end = pos;
+    while (end < query.size() && isalpha(static_cast<unsigned char>(query[end])))
+    {
+        ++end;
+    }
+    string verb = boost::to_lower_copy(query.substr(pos, end - pos));
+    if (verb != "select" && verb != "insert" && verb != "update" && verb != "delete")
+    {
+        return false;
+    }
+
+    m_text.reserve(query.size());
+    pos = 0;
+    while (pos < query.size())
+    {
+        char c = query[pos];
+        char next = (pos + 1 < query.size() ? query[pos + 1] : 0);
+        if (c == '\'')
+        {
+            if (!parse_string(query, pos, c))
+            {
+                return false;
+            }
+        } else if (c == '$' && next == '$')
+        {
+            if (!parse_string(query, pos, c))
+            {
+                return false;
+            }
+        } else if (c == '"')
+        {
+            // quoted identifier, copy as is
+            size_t close = query.find('"', pos + 1);
+            while (close != string::npos && close + 1 < query.size() && query[close + 1] == '"')
+            {
+                close = query.find('"', close + 2);
+            }
+            if (close == string::npos)
+            {
+                return false;
+            }
+            m_text.append(query, pos, close + 1 - pos);
+            pos = close + 1;
+        } else if (c == '?'
+                   || (c == '-' && next == '-')
+                   || (c == '/' && (next == '/' || next == '*')))
+        {
+            // already has bind markers, or has comments. Leave it alone.
+            return false;
+        } else if (is_hex_char(c) && parse_uuid(query, pos))
+        {
+            // uuid literal, can start with a letter
+        } else if (c == '0' && (next == 'x' || next == 'X'))
+        {
+            if (!parse_hex(query, pos))
+            {
+                return false;
+            }
+        } else if (is_ident_char(c))
+        {
+            // identifiers, and number literals, which stay in the text
+            size_t end = pos;
+            while (end < query.size() && is_ident_char(query[end]))
+            {
+                ++end;
+            }
+            string ident = query.substr(pos, end - pos);
+            if (boost::iequals(ident, "true") || boost::iequals(ident, "false"))
+            {
+                add_marker(CqlLiteral::BOOL_KIND);
+                m_literals.back().m_int = boost::iequals(ident, "true");
+            } else
+            {
+                m_text.append(ident);
+            }
+            pos = end;
+        } else
+        {
+            m_text.append(1, c);
+            ++pos;
+        }
+    }
+    m_key = m_text;
+    m_key.append(1, '\0');
+    for (auto it = m_literals.begin(); it != m_literals.end(); ++it)
+    {
+        m_key.append(1, char(it->m_kind));
+    }
+    return true;
+}
+
+void CqlTemplate::add_marker(CqlLiteral::Kind kind)
+{
+    m_text.append(1, '?');
+    m_literals.push_back(CqlLiteral());
+    m_literals.back().m_kind = kind;
+    m_literals.back().m_int = 0;
+}
+
+// pos is on the opening quote (or the first '$' of "$$")
+bool CqlTemplate::parse_string(const std::string& query, size_t& pos, char quote)
+{
+    string value;
+    if (quote == '$')
+    {
+        size_t close = query.find("$$", pos + 2);
+        if (close == string::npos)
+        {
+            return false;
+        }
+        value.assign(query, pos + 2, close - pos - 2);
+        pos = close + 2;
+    } else
+    {
+        size_t cur = pos + 1;
+        while (true)
+        {
+            size_t close = query.find(quote, cur);
+            if (close == string::npos)
+            {
+                return false;
+            }
+            value.append(query, cur, close - cur);
+            if (close + 1 < query.size() && query[close + 1] == quote)
+            {
+                // escaped quote
+                value.append(1, quote);
+                cur = close + 2;
+            } else
+            {
+                pos = close + 1;
+                break;
+            }
+        }
+    }
+    add_marker(CqlLiteral::STRING_KIND);
+    m_literals.back().m_text.swap(value);
+    return true;
+}
+
+// pos is on "0x"
+bool CqlTemplate::parse_hex(const std::string& query, size_t& pos)
+{
+    size_t end = pos + 2;
+    while (end < query.size() && is_hex_char(query[end]))
+    {
+        ++end;
+    }
+    size_t num_digits = end - pos - 2;
+    if ((num_digits % 2) || (end < query.size() && is_ident_char(query[end])))
+    {
+        return false;
+    }
+    add_marker(CqlLiteral::BYTES_KIND);
+    string& bytes = m_literals.back().m_text;
+    bytes.reserve(num_digits / 2);
+    for (size_t i = pos + 2; i < end; i += 2)
+    {
+        bytes.append(1, char(strtol(query.substr(i, 2).c_str(), 0, 16)));
+    }
+    pos = end;
+    return true;
+}
+
+// looking for 550e8400-e29b-41d4-a716-446655440000 at pos
+bool CqlTemplate::parse_uuid(const std::string& query, size_t& pos)
+{
+    static const size_t uuid_len = 36;
+    if (pos + uuid_len > query.size()
+        || (pos + uuid_len < query.size() && is_ident_char(query[pos + uuid_len])))
+    {
+        return false;
+    }
+    for (size_t i = 0; i < uuid_len; ++i)
+    {
+        char c = query[pos + i];
+        bool ok = (i == 8 || i == 13 || i == 18 || i == 23) ? c == '-' : is_hex_char(c);
+        if (!ok)
+        {
+            return false;
+        }
+    }
+    add_marker(CqlLiteral::UUID_KIND);
+    m_literals.back().m_uuid.assign(query.substr(pos, uuid_len));
+    pos += uuid_len;
+    return true;
+}
+
+bool CqlTemplate::bind(CassStatement* statement) const
+{
+    for (size_t i = 0; i < m_literals.size(); ++i)
+    {
+        const CqlLiteral& lit = m_literals[i];
+        CassError rc = CASS_OK;
+        switch (lit.m_kind)
+        {
+            case CqlLiteral::BOOL_KIND:
+                rc = cass_statement_bind_bool(statement, i, lit.m_int ? cass_true : cass_false);
+                break;
+            case CqlLiteral::STRING_KIND:
+            {
+                CassString val;
+                val.data = lit.m_text.data();
+                val.length = lit.m_text.size();
+                rc = cass_statement_bind_string(statement, i, val);
+                break;
+            }
+            case CqlLiteral::BYTES_KIND:
+            {
+                CassBytes val;
+                val.data = reinterpret_cast<const cass_byte_t*>(lit.m_text.data());
+                val.size = lit.m_text.size();
+                rc = cass_statement_bind_bytes(statement, i, val);
+                break;
+            }
+            case CqlLiteral::UUID_KIND:
+                rc = cass_statement_bind_uuid(statement, i, lit.m_uuid.get_uuid());
+                break;
+        }
+        if (rc != CASS_OK)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
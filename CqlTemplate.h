@@ -0,0 +1,84 @@
+#ifndef CB_CQL_TEMPLATE_H
+#define CB_CQL_TEMPLATE_H
+
+#include <string>
+#include <vector>
+#include <cassandra.h>
+#include "cql-interface/RefId.h"
+
+namespace cb {
+
+    // a literal value pulled out of a cql query by CqlTemplate
+    struct CqlLiteral
+    {
+        enum Kind { BOOL_KIND = 'b', STRING_KIND = 's', UUID_KIND = 'u', BYTES_KIND = 'x' };
+
+        Kind m_kind;
+        int64_t m_int;          // BOOL_KIND
+        std::string m_text;     // STRING_KIND, or the raw bytes for BYTES_KIND
+        RefId m_uuid;           // UUID_KIND
+    };
+
+    // splits a text query into a template with "?" in place of each literal,
+    // plus the literal values. Used by the CassConn statement cache so queries
+    // which only differ in their literals share one prepared statement.
+    //
+    //   select value from other_test_data where value in ('a', 'b')
+    // becomes
+    //   select value from other_test_data where value in (?, ?)
+    //
+    // Literal types are taken from how they are written ('a' is text, true a
+    // boolean, etc). If the server wants a different type for a value, executing
+    // the prepared statement fails and CassConn falls back to the plain text
+    // query for that template.
+    //
+    // Number literals stay in the text. 2 could be an int, a float or a decimal,
+    // and the server takes an int bound to a float column without complaint, so
+    // binding them from how they look would store the wrong value.
+    class CqlTemplate
+    {
+    public:
+
+        typedef std::vector<CqlLiteral> Literals;
+
+        // returns false if query should just be run as text. Only select, insert,
+        // update and delete queries are templated.
+        bool parse(const std::string& query);
+
+        // the query with literals replaced by "?"
+        const std::string& text() const
+        {
+            return m_text;
+        }
+
+        // text() plus the kinds of the literals. Use this for cache lookups since
+        // the same text with different literal types needs another prepared statement.
+        const std::string& key() const
+        {
+            return m_key;
+        }
+
+        const Literals& literals() const
+        {
+            return m_literals;
+        }
+
+        // binds the literals to a statement prepared from text()
+        bool bind(CassStatement* statement) const;
+
+    protected:
+
+        bool parse_string(const std::string& query, size_t& pos, char quote);
+        bool parse_hex(const std::string& query, size_t& pos);
+        bool parse_uuid(const std::string& query, size_t& pos);
+
+        void add_marker(CqlLiteral::Kind kind);
+
+        std::string m_text;
+        std::string m_key;
+        Literals m_literals;
+    };
+}
+
+#endif
+
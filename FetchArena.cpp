@@ -0,0 +1,87 @@
+#include <cstdlib>
+
+#include "cql-interface/FetchArena.h"
+
+using namespace cb;
+using namespace std;
+
+const size_t FetchArena::def_block_size;
+
+FetchArena::FetchArena(size_t block_size)
+: m_block_size(block_size ? block_size : def_block_size),
+  m_current(0),
+  m_pos(0),
+  m_end(0),
+  m_used_before(0),
+  m_capacity(0),
+  m_num_block_allocs(0)
+{
+}
+
+FetchArena::~FetchArena()
+{
+    for (auto it = m_blocks.begin(); it != m_blocks.end(); ++it)
+    {
+        free(it->m_data);
+    }
+}
+
+void FetchArena::reset()
+{
+    m_current = 0;
+    m_used_before = 0;
+    if (m_blocks.empty())
+    {
+        m_pos = m_end = 0;
+    } else
+    {
+        m_pos = reinterpret_cast<uintptr_t>(m_blocks[0].m_data);
+        m_end = m_pos + m_blocks[0].m_size;
+    }
+}
+
+size_t FetchArena::used() const
+{
+    if (m_blocks.empty())
+    {
+        return 0;
+    }
+    return m_used_before + (m_pos - reinterpret_cast<uintptr_t>(m_blocks[m_current].m_data));
+}
+
+void* FetchArena::allocate_slow(size_t size, size_t align)
+{
+    // move on to the next kept block which is big enough, 
+    // otherwise add a block after the current one
+    size_t need = size + align;
+    while (!m_blocks.empty() && m_current + 1 < m_blocks.size())
+    {
+        m_used_before += m_pos - reinterpret_cast<uintptr_t>(m_blocks[m_current].m_data);
+        ++m_current;
+        m_pos = reinterpret_cast<uintptr_t>(m_blocks[m_current].m_data);
+        m_end = m_pos + m_blocks[m_current].m_size;
+        if (m_blocks[m_current].m_size >= need)
+        {
+            return allocate(size, align);
+        }
+    }
+
+    Block block;
+    block.m_size = max(m_block_size, need);
+    block.m_data = static_cast<char*>(malloc(block.m_size));
+    if (!block.m_data)
+    {
+        throw bad_alloc();
+    }
+    ++m_num_block_allocs;
+    m_capacity += block.m_size;
+    if (!m_blocks.empty())
+    {
+        m_used_before += m_pos - reinterpret_cast<uintptr_t>(m_blocks[m_current].m_data);
+        m_current = m_blocks.size();
+    }
+    m_blocks.push_back(block);
+    m_pos = reinterpret_cast<uintptr_t>(block.m_data);
+    m_end = m_pos + block.m_size;
+    return allocate(size, align);
+}
@@ -0,0 +1,249 @@
+#ifndef CB_FETCH_ARENA_H
+#define CB_FETCH_ARENA_H
+
+#include <stdint.h>
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "cql-interface/FetchHelper.h"
+
+namespace cb {
+
+    // bump allocator for values decoded by a fetch. Text, blobs and collections
+    // fetched with ArenaFetchHelper are copied into big blocks here instead of
+    // each getting its own std::string, CassBytesMgr or std::vector, and are all
+    // released at once with reset. The blocks are kept for the next fetch (or page),
+    // so a reused arena stops allocating once it has grown to the size of a fetch.
+    //
+    // Not thread safe, use one per fetcher.
+    class FetchArena
+    {
+    public:
+
+        static const size_t def_block_size = 64*1024;
+
+        explicit FetchArena(size_t block_size = def_block_size);
+        ~FetchArena();
+
+        // size bytes aligned to align, good until reset or the arena goes away
+        void* allocate(size_t size, size_t align = alignof(std::max_align_t))
+        {
+            uintptr_t pos = (m_pos + align - 1) & ~uintptr_t(align - 1);
+            if (pos + size > m_end)
+            {
+                return allocate_slow(size, align);
+            }
+            m_pos = pos + size;
+            return reinterpret_cast<void*>(pos);
+        }
+
+        template <typename T>
+        T* allocate_array(size_t n)
+        {
+            static_assert(std::is_trivially_destructible<T>::value,
+                          "arena values are never destroyed");
+            return static_cast<T*>(allocate(n * sizeof(T), alignof(T)));
+        }
+
+        // frees everything allocated, keeping the blocks for reuse
+        void reset();
+
+        // bytes handed out since the last reset
+        size_t used() const;
+
+        // total size of the blocks held
+        size_t capacity() const
+        {
+            return m_capacity;
+        }
+
+        // number of blocks the arena has had to allocate, ever
+        uint64_t num_block_allocs() const
+        {
+            return m_num_block_allocs;
+        }
+
+    private:
+
+        FetchArena(const FetchArena&) = delete;
+        FetchArena& operator=(const FetchArena&) = delete;
+
+        void* allocate_slow(size_t size, size_t align);
+
+        struct Block
+        {
+            char* m_data;
+            size_t m_size;
+        };
+
+        std::vector<Block> m_blocks;
+        size_t m_block_size;
+        size_t m_current;        // index in m_blocks being allocated from
+        uintptr_t m_pos;
+        uintptr_t m_end;
+        size_t m_used_before;    // bytes used in blocks before m_current
+        size_t m_capacity;
+        uint64_t m_num_block_allocs;
+    };
+
+    // text in a FetchArena
+    struct ArenaText
+    {
+        const char* data = 0;
+        size_t length = 0;
+
+        std::string str() const
+        {
+            return std::string(data, length);
+        }
+
+        bool operator==(const std::string& other) const
+        {
+            return length == other.size() && other.compare(0, length, data, length) == 0;
+        }
+    };
+
+    // blob in a FetchArena
+    struct ArenaBytes
+    {
+        const cass_byte_t* data = 0;
+        size_t size = 0;
+    };
+
+    // list or set in a FetchArena, sized exactly from the collection item count.
+    // Maps are an ArenaArray<std::pair<K,V>> in the order the server sends them.
+    template <typename T>
+    struct ArenaArray
+    {
+        const T* data = 0;
+        size_t size = 0;
+
+        const T* begin() const
+        {
+            return data;
+        }
+
+        const T* end() const
+        {
+            return data + size;
+        }
+
+        const T& operator[](size_t i) const
+        {
+            return data[i];
+        }
+    };
+
+    // FetchHelper::get_nth for arena values. The plain types still work too.
+    //
+    //     virtual bool fetch(const CassRow& row)
+    //     {
+    //         m_rows.emplace_back();
+    //         return ArenaFetchHelper::get_nth(0, m_rows.back().docid, row, m_arena)
+    //                 && ArenaFetchHelper::get_nth(1, m_rows.back().value_list, row, m_arena);
+    //     }
+    class ArenaFetchHelper : public FetchHelper
+    {
+    public:
+
+        using FetchHelper::get_nth;
+
+        template <typename T>
+        static bool get_nth(int field,
+                            T& val,
+                            const CassRow& row,
+                            FetchArena& arena,
+                            cass_fld_required_enum_t req_opt
+                                  = CASS_FLD_IS_REQUIRED_ENUM)
+        {
+            const CassValue* cass_value = cass_row_get_column(&row, field);
+            if (cass_value_is_null(cass_value))
+            {
+                val = T();
+                return req_opt != CASS_FLD_IS_REQUIRED_ENUM;
+            }
+            return did_extract(val, cass_value, arena);
+        }
+
+    protected:
+
+        using FetchHelper::did_extract;
+
+        // fixed size values need no arena
+        template <typename T>
+        static bool did_extract(T& val, const CassValue* cass_value, FetchArena& arena)
+        {
+            return did_extract(val, cass_value);
+        }
+
+        static bool did_extract(ArenaText& val, const CassValue* cass_value, FetchArena& arena)
+        {
+            CassString tmp;
+            if (cass_value_get_string(cass_value, &tmp) != CASS_OK)
+            {
+                return false;
+            }
+            char* data = arena.allocate_array<char>(tmp.length);
+            std::copy(tmp.data, tmp.data + tmp.length, data);
+            val.data = data;
+            val.length = tmp.length;
+            return true;
+        }
+
+        static bool did_extract(ArenaBytes& val, const CassValue* cass_value, FetchArena& arena)
+        {
+            CassBytes tmp;
+            if (cass_value_get_bytes(cass_value, &tmp) != CASS_OK)
+            {
+                return false;
+            }
+            cass_byte_t* data = arena.allocate_array<cass_byte_t>(tmp.size);
+            std::copy(tmp.data, tmp.data + tmp.size, data);
+            val.data = data;
+            val.size = tmp.size;
+            return true;
+        }
+
+        template <typename T>
+        static bool did_extract(ArenaArray<T>& val, const CassValue* cass_value, FetchArena& arena)
+        {
+            size_t num_items = cass_value_item_count(cass_value);
+            T* data = arena.allocate_array<T>(num_items);
+            size_t i = 0;
+            bool retVal = true;
+            CassIterator* items_iterator = cass_iterator_from_collection(cass_value);
+            while (retVal && i < num_items && cass_iterator_next(items_iterator))
+            {
+                retVal = did_extract_item(data[i++], items_iterator, arena);
+            }
+            cass_iterator_free(items_iterator);
+            val.data = data;
+            val.size = i;
+            return retVal;
+        }
+
+        template <typename T>
+        static bool did_extract_item(T& val, CassIterator* items_iterator, FetchArena& arena)
+        {
+            new (&val) T();
+            return did_extract(val, cass_iterator_get_value(items_iterator), arena);
+        }
+
+        // map entries come as key then value
+        template <typename S, typename T>
+        static bool did_extract_item(std::pair<S,T>& val, CassIterator* items_iterator, FetchArena& arena)
+        {
+            new (&val) std::pair<S,T>();
+            return did_extract(val.first, cass_iterator_get_value(items_iterator), arena)
+                    && cass_iterator_next(items_iterator)
+                    && did_extract(val.second, cass_iterator_get_value(items_iterator), arena);
+        }
+    };
+}
+
+#endif
+
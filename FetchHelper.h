@@ -5,6 +5,10 @@
 #include <set>
 #include <map>
 #include <list>
+#include <utility>
+#if __cplusplus >= 201703L
+#include <string_view>
+#endif
 #include "log4cxx/logger.h"
 #include "cql-interface/CassConn.h"
 #include "cql-interface/RefId.h"
@@ -42,6 +46,41 @@ namespace cb {
             return did_extract(val, cass_value);
         }
 
+        // decodes a value already taken from a row, which must not be null.
+        // For callers that look at the CassValue themselves, see FetchColumn.
+        template <typename T>
+        static bool get_value(T& val, const CassValue* cass_value)
+        {
+            return did_extract(val, cass_value);
+        }
+
+        // a container entry from a row, see ConFetcher. Column 0 for a single
+        // value, columns 0 and 1 for a pair, so a select of key and value fills a map.
+        template<typename T> 
+        static bool get_entry(T& val, const CassRow& row)
+        {
+            return get_nth(0, val, row);
+        }
+
+        template<typename S, typename T> 
+        static bool get_entry(std::pair<S,T>& val, const CassRow& row)
+        {
+            return get_nth(0, val.first, row) && get_nth(1, val.second, row);
+        }
+
+        // column i goes into the i-th val, stopping at the first one which fails.
+        // Expands at compile time, so it costs the same as the get_nth calls by hand.
+        template <typename... Ts>
+        static bool get_columns(const CassRow& row, Ts&... vals)
+        {
+            return get_columns_from(0, row, vals...);
+        }
+
+        // the collection get_nth decode in place over what val already holds, so
+        // a val reused from row to row keeps its capacity (and, for strings, their
+        // buffers). Sets and maps come from the server sorted, so they are 
+        // filled with an end hint rather than a search per item.
+
         template <typename T>
         static bool get_nth(int field, 
                             std::vector<T>& val, 
@@ -49,27 +88,53 @@ namespace cb {
                             cass_fld_required_enum_t req_opt 
                                   = CASS_FLD_IS_REQUIRED_ENUM)
         {
-            val.clear();
             const CassValue* cass_value = cass_row_get_column(&row, field);
             if (cass_value_is_null(cass_value))
             {
+                val.clear();
                 return req_opt != CASS_FLD_IS_REQUIRED_ENUM;
             }
-            CassIterator* items_iterator = cass_iterator_from_collection(cass_value);
-            T tmp;
-            while(cass_iterator_next(items_iterator))
+            val.resize(cass_value_item_count(cass_value));
+            size_t num_items = 0;
+            ItemsIterator items(cass_value);
+            while (num_items < val.size() && items.next())
             {
-                if (did_extract(tmp, cass_iterator_get_value(items_iterator)))
+                if (!did_extract(val[num_items++], items.value()))
                 {
-                    val.push_back(tmp);
-                } else
+                    val.resize(num_items - 1);
+                    log_collection_error("vector");
+                    return false;
+                }
+            }
+            val.resize(num_items);
+            return true;
+        }
+
+        // vector<bool> items are only proxies, so decode into a local
+        static bool get_nth(int field, 
+                            std::vector<bool>& val, 
+                            const CassRow& row,
+                            cass_fld_required_enum_t req_opt 
+                                  = CASS_FLD_IS_REQUIRED_ENUM)
+        {
+            const CassValue* cass_value = cass_row_get_column(&row, field);
+            val.clear();
+            if (cass_value_is_null(cass_value))
+            {
+                return req_opt != CASS_FLD_IS_REQUIRED_ENUM;
+            }
+            val.reserve(cass_value_item_count(cass_value));
+            ItemsIterator items(cass_value);
+            while (items.next())
+            {
+                bool tmp = false;
+                if (!did_extract(tmp, items.value()))
                 {
-                    static log4cxx::LoggerPtr logger(log4cxx::Logger::getLogger("cb.cass_fetch_helper"));
-                    LOG4CXX_ERROR(logger, "failed reading a vector collection value");
+                    log_collection_error("vector");
                     return false;
                 }
+                val.push_back(tmp);
             }
-            cass_iterator_free(items_iterator);
             return true;
         }
 
@@ -80,27 +145,29 @@ namespace cb {
                             cass_fld_required_enum_t req_opt 
                                   = CASS_FLD_IS_REQUIRED_ENUM)
         {
-            val.clear();
             const CassValue* cass_value = cass_row_get_column(&row, field);
             if (cass_value_is_null(cass_value))
             {
+                val.clear();
                 return req_opt != CASS_FLD_IS_REQUIRED_ENUM;
             }
-            CassIterator* items_iterator = cass_iterator_from_collection(cass_value);
-            T tmp;
-            while(cass_iterator_next(items_iterator))
+            auto it = val.begin();
+            ItemsIterator items(cass_value);
+            while (items.next())
             {
-                if (did_extract(tmp, cass_iterator_get_value(items_iterator)))
+                if (it == val.end())
                 {
-                    val.push_back(tmp);
-                } else
+                    it = val.emplace(it);
+                }
+                if (!did_extract(*it, items.value()))
                 {
-                    static log4cxx::LoggerPtr logger(log4cxx::Logger::getLogger("cb.cass_fetch_helper"));
-                    LOG4CXX_ERROR(logger, "failed reading a list collection value");
+                    val.erase(it, val.end());
+                    log_collection_error("list");
                     return false;
                 }
+                ++it;
             }
-            cass_iterator_free(items_iterator);
+            val.erase(it, val.end());
             return true;
         }
 
@@ -117,21 +184,17 @@ namespace cb {
             {
                 return req_opt != CASS_FLD_IS_REQUIRED_ENUM;
             }
-            CassIterator* items_iterator = cass_iterator_from_collection(cass_value);
+            ItemsIterator items(cass_value);
             T tmp;
-            while(cass_iterator_next(items_iterator))
+            while (items.next())
             {
-                if (did_extract(tmp, cass_iterator_get_value(items_iterator)))
-                {
-                    val.insert(tmp);
-                } else
+                if (!did_extract(tmp, items.value()))
                 {
-                    static log4cxx::LoggerPtr logger(log4cxx::Logger::getLogger("cb.cass_fetch_helper"));
-                    LOG4CXX_ERROR(logger, "failed reading a set collection value");
+                    log_collection_error("set");
                     return false;
                 }
+                val.emplace_hint(val.end(), std::move(tmp));
             }
-            cass_iterator_free(items_iterator);
             return true;
         }
 
@@ -142,32 +205,26 @@ namespace cb {
                             cass_fld_required_enum_t req_opt 
                                   = CASS_FLD_IS_REQUIRED_ENUM)
         {
-            static log4cxx::LoggerPtr logger(log4cxx::Logger::getLogger("cb.cass_fetch_helper"));
             val.clear();
             const CassValue* cass_value = cass_row_get_column(&row, field);
             if (cass_value_is_null(cass_value))
             {
                 return req_opt != CASS_FLD_IS_REQUIRED_ENUM;
             }
-            CassIterator* items_iterator = cass_iterator_from_collection(cass_value);
+            ItemsIterator items(cass_value);
             S tmp_key;
             T tmp_val;
-            while(cass_iterator_next(items_iterator))
+            while (items.next())
             {
-                if (did_extract(tmp_key, cass_iterator_get_value(items_iterator))
-                    && cass_iterator_next(items_iterator)
-                    && did_extract(tmp_val, cass_iterator_get_value(items_iterator)))
+                if (!did_extract(tmp_key, items.value())
+                    || !items.next()
+                    || !did_extract(tmp_val, items.value()))
                 {
-                    LOG4CXX_TRACE(logger, "extracted key: " << tmp_key
-                                            << " and value: " << tmp_val);
-                    val[tmp_key] = tmp_val;
-                } else
-                {
-                    LOG4CXX_ERROR(logger, "failed reading a map collection value");
+                    log_collection_error("map");
                     return false;
                 }
+                val.emplace_hint(val.end(), std::move(tmp_key), std::move(tmp_val));
             }
-            cass_iterator_free(items_iterator);
             return true;
         }
 
@@ -178,11 +235,34 @@ namespace cb {
                             cass_fld_required_enum_t req_opt 
                                   = CASS_FLD_IS_REQUIRED_ENUM)
         {
-            std::pair<S,T> tmp;
-            return get_nth(field, val, tmp, row, req_opt);
+            const CassValue* cass_value = cass_row_get_column(&row, field);
+            if (cass_value_is_null(cass_value))
+            {
+                val.clear();
+                return req_opt != CASS_FLD_IS_REQUIRED_ENUM;
+            }
+            // the item count of a map may be its number of keys and values
+            val.resize(cass_value_item_count(cass_value));
+            size_t num_items = 0;
+            ItemsIterator items(cass_value);
+            while (num_items < val.size() && items.next())
+            {
+                std::pair<S,T>& item = val[num_items++];
+                if (!did_extract(item.first, items.value())
+                    || !items.next()
+                    || !did_extract(item.second, items.value()))
+                {
+                    val.resize(num_items - 1);
+                    log_collection_error("map");
+                    return false;
+                }
+            }
+            val.resize(num_items);
+            return true;
         }
 
-        // use this map fetcher to avoid allocation of the tmp data holder
+        // tmp is no longer needed, the pairs are decoded in place in val.
+        // Kept for old callers.
         template <typename S, typename T>
         static bool get_nth(int field, 
                             std::vector<std::pair<S,T>>& val, 
@@ -191,34 +271,63 @@ namespace cb {
                             cass_fld_required_enum_t req_opt 
                                   = CASS_FLD_IS_REQUIRED_ENUM)
         {
-            static log4cxx::LoggerPtr logger(log4cxx::Logger::getLogger("cb.cass_fetch_helper"));
-            val.clear();
-            const CassValue* cass_value = cass_row_get_column(&row, field);
-            if (cass_value_is_null(cass_value))
+            return get_nth(field, val, row, req_opt);
+        }
+
+    protected:
+
+        // walks a collection, freeing the iterator however the decode ends
+        class ItemsIterator
+        {
+        public:
+
+            explicit ItemsIterator(const CassValue* cass_value)
+            : m_iterator(cass_iterator_from_collection(cass_value))
             {
-                return req_opt != CASS_FLD_IS_REQUIRED_ENUM;
             }
-            CassIterator* items_iterator = cass_iterator_from_collection(cass_value);
-            while(cass_iterator_next(items_iterator))
+
+            ~ItemsIterator()
             {
-                if (did_extract(tmp.first, cass_iterator_get_value(items_iterator))
-                    && cass_iterator_next(items_iterator)
-                    && did_extract(tmp.second, cass_iterator_get_value(items_iterator)))
+                if (m_iterator)
                 {
-                    LOG4CXX_TRACE(logger, "extracted key: " << tmp.first
-                                            << " and value: " << tmp.second);
-                    val.push_back(tmp);
-                } else
-                {
-                    LOG4CXX_ERROR(logger, "failed reading a map collection value");
-                    return false;
+                    cass_iterator_free(m_iterator);
                 }
             }
-            cass_iterator_free(items_iterator);
+
+            bool next()
+            {
+                return m_iterator && cass_iterator_next(m_iterator);
+            }
+
+            const CassValue* value() const
+            {
+                return cass_iterator_get_value(m_iterator);
+            }
+
+        private:
+
+            ItemsIterator(const ItemsIterator&) = delete;
+            ItemsIterator& operator=(const ItemsIterator&) = delete;
+
+            CassIterator* m_iterator;
+        };
+
+        static void log_collection_error(const char* kind)
+        {
+            static log4cxx::LoggerPtr logger(log4cxx::Logger::getLogger("cb.cass_fetch_helper"));
+            LOG4CXX_ERROR(logger, "failed reading a " << kind << " collection value");
+        }
+
+        static bool get_columns_from(int field, const CassRow& row)
+        {
             return true;
         }
 
-    protected:
+        template <typename T, typename... Ts>
+        static bool get_columns_from(int field, const CassRow& row, T& val, Ts&... vals)
+        {
+            return get_nth(field, val, row) && get_columns_from(field + 1, row, vals...);
+        }
 
         static bool did_extract(bool& val_in, const CassValue* cass_value)
         {
@@ -277,6 +386,31 @@ namespace cb {
             return rc == CASS_OK;
         }
 
+        // views into the result, no copy. Only good while the result is held,
+        // so use these with CassConn::fetch_result.
+        static bool did_extract(CassString& val, const CassValue* cass_value)
+        {
+            return cass_value_get_string(cass_value, &val) == CASS_OK;
+        }
+
+        static bool did_extract(CassBytes& val, const CassValue* cass_value)
+        {
+            return cass_value_get_bytes(cass_value, &val) == CASS_OK;
+        }
+
+#if __cplusplus >= 201703L
+        static bool did_extract(std::string_view& val_in, const CassValue* cass_value)
+        {
+            CassString val;
+            CassError rc = cass_value_get_string(cass_value, &val);
+            if (rc == CASS_OK)
+            {
+                val_in = std::string_view(val.data, val.length);
+            }
+            return rc == CASS_OK;
+        }
+#endif
+
         static bool did_extract(RefId& val, const CassValue* cass_value)
         {
             return val.did_extract(cass_value);
@@ -341,6 +475,25 @@ namespace cb {
             val_in.clear();
         }
 
+        static void my_reset(CassString& val)
+        {
+            val.data = 0;
+            val.length = 0;
+        }
+
+        static void my_reset(CassBytes& val)
+        {
+            val.data = 0;
+            val.size = 0;
+        }
+
+#if __cplusplus >= 201703L
+        static void my_reset(std::string_view& val)
+        {
+            val = std::string_view();
+        }
+#endif
+
         static void my_reset(RefId& val)
         {
             val.reset();
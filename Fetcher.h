@@ -3,6 +3,7 @@
 
 #include "cql-interface/FetchHelper.h"
 #include "cql-interface/CassConn.h"
+#include "cql-interface/PreparedFetch.h"
 
 namespace cb {
 
@@ -33,6 +34,16 @@ namespace cb {
             return CassConn::fetch(query, *this, consist, timeout_in_micro) && m_was_set;
         }
 
+        // fetch with a prepared select, binding Fargs. 
+        // will throw if there is an issue binding values.
+        template<typename... Targs>
+        bool do_fetch(PreparedFetch& prep_fetch, T& obj, const Targs&... Fargs)
+        {
+            m_was_set = false;
+            m_ptr = &obj;
+            return prep_fetch.fetch(*this, Fargs...) && m_was_set;
+        }
+
     protected:
 
         virtual bool fetch(const CassRow& result)
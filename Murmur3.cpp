@@ -0,0 +1,116 @@
+#include <string.h>
+#include <limits>
+
+#include "cql-interface/Murmur3.h"
+
+using namespace std;
+
+namespace {
+
+    inline uint64_t rotl64(uint64_t x, int8_t r)
+    {
+        return (x << r) | (x >> (64 - r));
+    }
+
+    inline uint64_t fmix64(uint64_t k)
+    {
+        k ^= k >> 33;
+        k *= 0xff51afd7ed558ccdULL;
+        k ^= k >> 33;
+        k *= 0xc4ceb9fe1a85ec53ULL;
+        k ^= k >> 33;
+        return k;
+    }
+
+    inline uint64_t get_block(const uint8_t* data, size_t index)
+    {
+        // little endian, independent of the host
+        const uint8_t* block = data + index * 8;
+        uint64_t retVal = 0;
+        for (int i = 7; i >= 0; --i)
+        {
+            retVal = (retVal << 8) | block[i];
+        }
+        return retVal;
+    }
+
+    // the server reads tail bytes as signed, so they get sign extended
+    inline uint64_t tail_byte(const uint8_t* tail, unsigned index)
+    {
+        return uint64_t(int64_t(int8_t(tail[index])));
+    }
+}
+
+namespace cb {
+
+int64_t murmur3_token(const void* key, size_t len)
+{
+    const uint8_t* data = static_cast<const uint8_t*>(key);
+    const size_t nblocks = len / 16;
+
+    uint64_t h1 = 0;
+    uint64_t h2 = 0;
+
+    const uint64_t c1 = 0x87c37b91114253d5ULL;
+    const uint64_t c2 = 0x4cf5ad432745937fULL;
+
+    for (size_t i = 0; i < nblocks; ++i)
+    {
+        uint64_t k1 = get_block(data, i * 2);
+        uint64_t k2 = get_block(data, i * 2 + 1);
+
+        k1 *= c1; k1 = rotl64(k1, 31); k1 *= c2; h1 ^= k1;
+        h1 = rotl64(h1, 27); h1 += h2; h1 = h1 * 5 + 0x52dce729;
+
+        k2 *= c2; k2 = rotl64(k2, 33); k2 *= c1; h2 ^= k2;
+        h2 = rotl64(h2, 31); h2 += h1; h2 = h2 * 5 + 0x38495ab5;
+    }
+
+    const uint8_t* tail = data + nblocks * 16;
+    uint64_t k1 = 0;
+    uint64_t k2 = 0;
+
+    switch (len & 15)
+    {
+        case 15: k2 ^= tail_byte(tail, 14) << 48;
+        case 14: k2 ^= tail_byte(tail, 13) << 40;
+        case 13: k2 ^= tail_byte(tail, 12) << 32;
+        case 12: k2 ^= tail_byte(tail, 11) << 24;
+        case 11: k2 ^= tail_byte(tail, 10) << 16;
+        case 10: k2 ^= tail_byte(tail, 9) << 8;
+        case  9: k2 ^= tail_byte(tail, 8);
+                 k2 *= c2; k2 = rotl64(k2, 33); k2 *= c1; h2 ^= k2;
+
+        case  8: k1 ^= tail_byte(tail, 7) << 56;
+        case  7: k1 ^= tail_byte(tail, 6) << 48;
+        case  6: k1 ^= tail_byte(tail, 5) << 40;
+        case  5: k1 ^= tail_byte(tail, 4) << 32;
+        case  4: k1 ^= tail_byte(tail, 3) << 24;
+        case  3: k1 ^= tail_byte(tail, 2) << 16;
+        case  2: k1 ^= tail_byte(tail, 1) << 8;
+        case  1: k1 ^= tail_byte(tail, 0);
+                 k1 *= c1; k1 = rotl64(k1, 31); k1 *= c2; h1 ^= k1;
+    }
+
+    h1 ^= len;
+    h2 ^= len;
+
+    h1 += h2;
+    h2 += h1;
+
+    h1 = fmix64(h1);
+    h2 = fmix64(h2);
+
+    h1 += h2;
+
+    int64_t retVal = int64_t(h1);
+
+    // the partitioner keeps the min value for itself
+    if (retVal == numeric_limits<int64_t>::min())
+    {
+        retVal = numeric_limits<int64_t>::max();
+    }
+    return retVal;
+}
+
+}
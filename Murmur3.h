@@ -0,0 +1,120 @@
+#ifndef CB_MURMUR3_H
+#define CB_MURMUR3_H
+
+#include <stdint.h>
+#include <string>
+#include <cassandra.h>
+#include "cql-interface/RefId.h"
+
+namespace cb {
+
+    // token for a serialized partition key, matching the server Murmur3Partitioner.
+    // Cassandra uses the x64_128 hash with the tail bytes sign extended; the token
+    // is the first 64 bits.
+    int64_t murmur3_token(const void* data, size_t len);
+
+    inline int64_t murmur3_token(const std::string& key)
+    {
+        return murmur3_token(key.data(), key.size());
+    }
+
+    // serializes partition key values the way the server does before hashing.
+    // One value is just its bytes. More than one is a composite key, each part
+    // as a 2 byte length, the bytes and a 0 byte.
+    class PartitionKey
+    {
+    public:
+
+        template<typename... Targs>
+        static std::string make(const Targs&... Fargs)
+        {
+            std::string retVal;
+            if (sizeof...(Fargs) == 1)
+            {
+                append_all(retVal, false, Fargs...);
+            } else
+            {
+                append_all(retVal, true, Fargs...);
+            }
+            return retVal;
+        }
+
+        template<typename... Targs>
+        static int64_t token(const Targs&... Fargs)
+        {
+            return murmur3_token(make(Fargs...));
+        }
+
+        // the serialized bytes of each supported type
+        static void append(std::string& key, cass_int32_t val)
+        {
+            append_big_endian(key, uint32_t(val), 4);
+        }
+        static void append(std::string& key, cass_int64_t val)
+        {
+            append_big_endian(key, uint64_t(val), 8);
+        }
+        static void append(std::string& key, bool val)
+        {
+            key.append(1, char(val ? 1 : 0));
+        }
+        static void append(std::string& key, const std::string& val)
+        {
+            key.append(val);
+        }
+        static void append(std::string& key, const char* val)
+        {
+            key.append(val);
+        }
+        static void append(std::string& key, const CassString& val)
+        {
+            key.append(val.data, val.length);
+        }
+        static void append(std::string& key, const CassBytes& val)
+        {
+            key.append(reinterpret_cast<const char*>(val.data), val.size);
+        }
+        static void append(std::string& key, const CassUuid& val)
+        {
+            key.append(reinterpret_cast<const char*>(val), CASS_UUID_NUM_BYTES);
+        }
+        static void append(std::string& key, const cb::RefId& val)
+        {
+            append(key, val.get_uuid());
+        }
+
+    private:
+
+        static void append_big_endian(std::string& key, uint64_t val, unsigned num_bytes)
+        {
+            for (unsigned i = num_bytes; i > 0; --i)
+            {
+                key.append(1, char((val >> (8 * (i - 1))) & 0xff));
+            }
+        }
+
+        static void append_all(std::string& key, bool composite)
+        {
+        }
+
+        template<typename T, typename... Targs>
+        static void append_all(std::string& key, bool composite, const T& val, const Targs&... Fargs)
+        {
+            if (composite)
+            {
+                std::string part;
+                append(part, val);
+                append_big_endian(key, part.size(), 2);
+                key.append(part);
+                key.append(1, '\0');
+            } else
+            {
+                append(key, val);
+            }
+            append_all(key, composite, Fargs...);
+        }
+    };
+}
+
+#endif 
+
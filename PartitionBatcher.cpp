@@ -0,0 +1,101 @@
+#include <algorithm>
+#include <deque>
+#include "cql-interface/PartitionBatcher.h"
+#include "cql-interface/CassConn.h"
+
+using namespace cb;
+using namespace std;
+
+PartitionBatcher::PartitionBatcher(size_t max_bytes)
+: m_max_bytes(max_bytes),
+  m_has_consist(false),
+  m_consist(CASS_CONSISTENCY_LOCAL_QUORUM),
+  m_timeout_in_micro(0),
+  m_num_statements(0)
+{
+}
+
+PartitionBatcher::PartitionBatcher(size_t max_bytes,
+                                   CassConsistency consist,
+                                   cass_duration_t timeout_in_micro)
+: m_max_bytes(max_bytes),
+  m_has_consist(true),
+  m_consist(consist),
+  m_timeout_in_micro(timeout_in_micro),
+  m_num_statements(0)
+{
+}
+
+PartitionBatcher::BatchBuilderPtr PartitionBatcher::new_batch() const
+{
+    if (m_has_consist)
+    {
+        return BatchBuilderPtr(new BatchBuilder(BATCH_UNLOGGED_ENUM, m_max_bytes, 
+                                                m_consist, m_timeout_in_micro));
+    }
+    return BatchBuilderPtr(new BatchBuilder(BATCH_UNLOGGED_ENUM, m_max_bytes));
+}
+
+void PartitionBatcher::drop_new_batch(int64_t token)
+{
+    auto it = m_groups.find(token);
+    if (it != m_groups.end())
+    {
+        it->second.pop_back();
+        if (it->second.empty())
+        {
+            m_groups.erase(it);
+        }
+    }
+}
+
+size_t PartitionBatcher::num_batches() const
+{
+    size_t retVal = 0;
+    for (auto it = m_groups.begin(); it != m_groups.end(); ++it)
+    {
+        retVal += it->second.size();
+    }
+    return retVal;
+}
+
+bool PartitionBatcher::execute()
+{
+    // keeps under the driver pending queue, the same window as BulkWriter's default
+    const size_t window = std::max(CassConn::get_queue_size_io() / 2, 1u);
+
+    bool retVal = true;
+    deque<StoreHolderPtr> holders;
+    for (auto it = m_groups.begin(); it != m_groups.end(); ++it)
+    {
+        for (auto batch = it->second.begin(); batch != it->second.end(); ++batch)
+        {
+            // wait on the oldest until there is room
+            while (holders.size() >= window)
+            {
+                retVal = holders.front()->wait() && retVal;
+                holders.pop_front();
+            }
+            StoreHolderPtr holder(new StoreHolder());
+            if ((*batch)->async_execute(holder))
+            {
+                holders.push_back(holder);
+            } else
+            {
+                retVal = false;
+            }
+        }
+    }
+    for (auto it = holders.begin(); it != holders.end(); ++it)
+    {
+        retVal = (*it)->wait() && retVal;
+    }
+    clear();
+    return retVal;
+}
+
+void PartitionBatcher::clear()
+{
+    m_groups.clear();
+    m_num_statements = 0;
+}
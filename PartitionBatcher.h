@@ -0,0 +1,110 @@
+#ifndef CB_PARTITION_BATCHER_H
+#define CB_PARTITION_BATCHER_H
+
+#include <map>
+#include <memory>
+#include <vector>
+#include "cql-interface/BatchBuilder.h"
+#include "cql-interface/Murmur3.h"
+
+namespace cb {
+
+    // groups writes by the token of their partition key and sends one unlogged
+    // batch per partition (more if a partition goes over max_bytes), so each
+    // batch is handled by its replicas without fanning out from the coordinator.
+    //
+    //     PartitionBatcher batcher;
+    //     batcher.add(PartitionKey::make(part_key), *prep_store, part_key, item, value);
+    //     batcher.execute();
+    //
+    // Not thread safe, use one per thread.
+    class PartitionBatcher
+    {
+    public:
+
+        explicit PartitionBatcher(size_t max_bytes = BatchBuilder::def_max_bytes);
+        PartitionBatcher(size_t max_bytes,
+                         CassConsistency consist,
+                         cass_duration_t timeout_in_micro = 0);
+
+        // partition_key is the serialized key, see PartitionKey::make.
+        // Binds the same as PreparedStore::store, will throw if there is an issue binding values.
+        template<typename... Targs>
+        bool add(const std::string& partition_key, PreparedStore& prep_store, const Targs&... Fargs)
+        {
+            return add_to(murmur3_token(partition_key), prep_store, Fargs...);
+        }
+
+        // same when the token is already known
+        template<typename... Targs>
+        bool add_to(int64_t token, PreparedStore& prep_store, const Targs&... Fargs)
+        {
+            Batches& batches = m_groups[token];
+            if (batches.empty() || !batches.back()->add(prep_store, Fargs...))
+            {
+                batches.push_back(new_batch());
+                bool was_added = false;
+                try
+                {
+                    was_added = batches.back()->add(prep_store, Fargs...);
+                } catch (...)
+                {
+                    drop_new_batch(token);
+                    throw;
+                }
+                if (!was_added)
+                {
+                    drop_new_batch(token);
+                    return false;
+                }
+            }
+            ++m_num_statements;
+            return true;
+        }
+
+        // sends all the batches and waits for them, keeping up to half of
+        // CassConn::get_queue_size_io in flight like BulkWriter.
+        // Returns false if any failed. Empty afterwards either way.
+        bool execute();
+
+        void clear();
+
+        // number of statements added
+        size_t size() const
+        {
+            return m_num_statements;
+        }
+
+        size_t num_partitions() const
+        {
+            return m_groups.size();
+        }
+
+        // number of batches execute will send
+        size_t num_batches() const;
+
+    private:
+
+        PartitionBatcher(const PartitionBatcher&) = delete;
+        PartitionBatcher& operator=(const PartitionBatcher&) = delete;
+
+        typedef std::unique_ptr<BatchBuilder> BatchBuilderPtr;
+        typedef std::vector<BatchBuilderPtr> Batches;
+
+        BatchBuilderPtr new_batch() const;
+
+        // takes back the batch add_to just made for token, after nothing went in it
+        void drop_new_batch(int64_t token);
+
+        size_t m_max_bytes;
+        bool m_has_consist;
+        CassConsistency m_consist;
+        cass_duration_t m_timeout_in_micro;
+
+        std::map<int64_t, Batches> m_groups;
+        size_t m_num_statements;
+    };
+}
+
+#endif 
+
@@ -0,0 +1,108 @@
+#ifndef CB_PREPARED_FETCH_H
+#define CB_PREPARED_FETCH_H
+
+#include <memory>
+#include "cql-interface/PreparedStatement.h"
+#include "cql-interface/CassFetcher.h"
+#include "cql-interface/CassFetcherHolder.h"
+
+namespace cb {
+
+    // use this to execute a prepared select statement. Binds with the same
+    // types as PreparedStore and runs the rows through any CassFetcher.
+    // Fetcher and ConFetcher take a PreparedFetch in their do_fetch calls.
+    class PreparedFetch : public PreparedStatement
+    {
+    public:
+
+        ~PreparedFetch()
+        {
+        }
+
+        // will throw if there is an issue binding values.
+        // Safe to call from many threads at once, as long as each has its own fetcher.
+        template<typename... Targs>
+        bool fetch(CassFetcher& fetcher, const Targs&... Fargs)
+        {
+            check_num_args(sizeof...(Fargs), "fetch");
+
+            bool was_unprepared = false;
+            bool retVal = execute(was_unprepared, fetcher, Fargs...);
+            if (!retVal && was_unprepared && reprepare())
+            {
+                // server dropped the prepared id (restart or schema change), so
+                // try once more with the newly prepared statement.
+                retVal = execute(was_unprepared, fetcher, Fargs...);
+            }
+            return retVal;
+        }
+
+        // like CassConn::fetch_paged, page_size rows at a time, at most max_rows (0 for all).
+        // Only prepares again if the first page finds the prepared id is gone.
+        template<typename... Targs>
+        bool fetch_paged(CassFetcher& fetcher, unsigned page_size, uint64_t max_rows, const Targs&... Fargs)
+        {
+            check_num_args(sizeof...(Fargs), "fetch_paged");
+
+            bool was_unprepared = false;
+            bool retVal = execute_paged(was_unprepared, fetcher, page_size, max_rows, Fargs...);
+            if (!retVal && was_unprepared && reprepare())
+            {
+                retVal = execute_paged(was_unprepared, fetcher, page_size, max_rows, Fargs...);
+            }
+            return retVal;
+        }
+
+        // fetch_holder picks up the rows into fetcher, see CassConn::async_fetch.
+        // Does not prepare again if the server lost the prepared id, the fetch just fails.
+        template<typename... Targs>
+        bool async_fetch(CassFetcherPtr fetcher, CassFetcherHolderPtr fetch_holder, const Targs&... Fargs)
+        {
+            check_num_args(sizeof...(Fargs), "async_fetch");
+
+            CassStatement* statement = new_statement(Fargs...);
+            bool retVal = CassConn::async_fetch(*this, statement, fetcher, fetch_holder);
+            cass_statement_free(statement);
+            return retVal;
+        }
+
+    protected:
+
+        // binds a fresh statement from m_prepared and fetches with it.
+        template<typename... Targs>
+        bool execute(bool& was_unprepared, CassFetcher& fetcher, const Targs&... Fargs)
+        {
+            CassStatement* statement = new_statement(Fargs...);
+            bool retVal = CassConn::fetch(*this, statement, fetcher, was_unprepared);
+            cass_statement_free(statement);
+            return retVal;
+        }
+
+        template<typename... Targs>
+        bool execute_paged(bool& was_unprepared, CassFetcher& fetcher, 
+                           unsigned page_size, uint64_t max_rows, const Targs&... Fargs)
+        {
+            auto page_statement = [&]()
+            {
+                return new_statement(Fargs...);
+            };
+            return CassConn::fetch_paged(*this, page_statement, fetcher, page_size, max_rows, was_unprepared);
+        }
+
+        friend class cb::CassConn;
+        // only created from CassConn
+        PreparedFetch(const std::string& query,
+                      const CassPrepared* prepared,
+                      unsigned num_args,
+                      CassConsistency consist,
+                      cass_duration_t timeout_in_micro)
+        : PreparedStatement("PreparedFetch", query, prepared, num_args, consist, timeout_in_micro)
+        {
+        }
+    };
+    typedef std::shared_ptr<PreparedFetch> PreparedFetchPtr;
+
+}
+
+#endif
+
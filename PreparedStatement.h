@@ -0,0 +1,720 @@
+#ifndef CB_PREPARED_STATEMENT_H
+#define CB_PREPARED_STATEMENT_H
+
+#include <memory>
+#include <atomic>
+#include <vector>
+#include <list>
+#include <set>
+#include <map>
+#include <deque>
+#include <array>
+#include <iterator>
+#include <unordered_set>
+#include <unordered_map>
+#include <sstream>
+#include <string.h>
+#if __cplusplus >= 201703L
+#include <string_view>
+#endif
+#include "cql-interface/CassConn.h"
+#include "cql-interface/CassBytesMgr.h"
+#include "cql-interface/RefId.h"
+#include "cql-interface/Exception.h"
+
+namespace cb {
+
+    // use this for binding null values
+    struct NullBinder
+    {
+    };
+
+    // views to bind text or blob data in place. The driver copies the value
+    // when it is bound, so the data only has to outlive the store/fetch call
+    // (async_store included), and the caller can free or reuse it right after.
+    // BulkWriter::write binds again on a retry, so it copies views first.
+    inline CassString as_text(const char* data, size_t size)
+    {
+        return cass_string_init2(data, size);
+    }
+
+    inline CassBytes as_bytes(const void* data, size_t size)
+    {
+        return cass_bytes_init(static_cast<const cass_byte_t*>(data), size);
+    }
+
+    inline CassBytes as_bytes(const std::string& data)
+    {
+        return as_bytes(data.data(), data.size());
+    }
+
+    inline CassBytes as_bytes(const std::vector<cass_byte_t>& data)
+    {
+        return as_bytes(data.empty() ? 0 : &data.front(), data.size());
+    }
+
+    // binds a list or set straight from a range of values, without first
+    // copying them into a std container. Use as_list, as_set or as_map:
+    //
+    //     prep_store->store(docid, as_list(ints, num_ints));
+    //
+    // The range must stay valid until the bind call returns.
+    template<typename It>
+    struct CollectionRange
+    {
+        CassCollectionType m_type;
+        It m_begin;
+        It m_end;
+        size_t m_size;      // number of values
+
+        It begin() const
+        {
+            return m_begin;
+        }
+
+        It end() const
+        {
+            return m_end;
+        }
+    };
+
+    template<typename It>
+    CollectionRange<It> as_list(It begin, It end)
+    {
+        return CollectionRange<It>{ CASS_COLLECTION_TYPE_LIST, begin, end, size_t(std::distance(begin, end)) };
+    }
+
+    template<typename T>
+    CollectionRange<const T*> as_list(const T* data, size_t size)
+    {
+        return CollectionRange<const T*>{ CASS_COLLECTION_TYPE_LIST, data, data + size, size };
+    }
+
+    template<typename It>
+    CollectionRange<It> as_set(It begin, It end)
+    {
+        return CollectionRange<It>{ CASS_COLLECTION_TYPE_SET, begin, end, size_t(std::distance(begin, end)) };
+    }
+
+    template<typename T>
+    CollectionRange<const T*> as_set(const T* data, size_t size)
+    {
+        return CollectionRange<const T*>{ CASS_COLLECTION_TYPE_SET, data, data + size, size };
+    }
+
+    // same for a map, It points to std::pair like values
+    template<typename It>
+    struct MapRange
+    {
+        It m_begin;
+        It m_end;
+        size_t m_size;      // number of pairs
+    };
+
+    template<typename It>
+    MapRange<It> as_map(It begin, It end)
+    {
+        return MapRange<It>{ begin, end, size_t(std::distance(begin, end)) };
+    }
+
+    // common part of PreparedStore and PreparedFetch.
+    // Holds the server side CassPrepared and binds fresh statements from it.
+    class PreparedStatement 
+    {
+    public:
+
+        virtual ~PreparedStatement()
+        {
+        }
+
+        const std::string& query() const
+        {
+            return m_query;
+        }
+
+        unsigned num_args() const
+        {
+            return m_num_args;
+        }
+
+        cass_duration_t timeout_in_micro() const
+        {
+            return m_timeout_in_micro;
+        }
+
+        // prepare m_query again on the server, replacing m_prepared.
+        // Statements already bound keep the old one alive until they are done.
+        // The sync calls do this themselves; after an async store, do it when
+        // StoreHolder::was_unprepared and store again.
+        // Waits on the server, so not from a driver callback.
+        bool reprepare()
+        {
+            const CassPrepared* prepared = CassConn::prepare(m_query, m_timeout_in_micro);
+            if (!prepared)
+            {
+                return false;
+            }
+            std::atomic_store(&m_prepared, 
+                              std::shared_ptr<const CassPrepared>(prepared, cass_prepared_free));
+            return true;
+        }
+
+    protected:
+
+        PreparedStatement(const char* name,
+                          const std::string& query,
+                          const CassPrepared* prepared, 
+                          unsigned num_args, 
+                          CassConsistency consist,
+                          cass_duration_t timeout_in_micro)
+        : m_name(name),
+          m_query(query.c_str()),                       // might be used in different threads.
+          m_num_args(num_args),
+          m_consist(consist),
+          m_timeout_in_micro(timeout_in_micro)
+        {
+            if (!prepared)
+            {
+                throw Exception(std::string("can't make ") + m_name + " with null prepared statement",
+                                 __FILE__, __LINE__);
+            }
+            m_prepared.reset(prepared, cass_prepared_free);
+        }
+
+        PreparedStatement() = delete;
+        PreparedStatement(const PreparedStatement&) = delete;
+        PreparedStatement& operator=(const PreparedStatement&) = delete;
+
+        // throws if called with the wrong number of args
+        void check_num_args(unsigned num_args, const char* call) const
+        {
+            if (m_num_args != num_args)
+            {
+                std::ostringstream err;
+                err << "must call " << call << " with " << m_num_args << " for " << m_name << ": " 
+                    << m_query.c_str();
+                throw Exception(err.str(), __FILE__, __LINE__);
+            }
+        }
+
+        // binds a fresh statement from m_prepared. Caller must cass_statement_free it.
+        // will throw if bind fails, since this is not expected.
+        template<typename... Targs>
+        CassStatement* new_statement(const Targs&... Fargs)
+        {
+            std::shared_ptr<const CassPrepared> prepared = std::atomic_load(&m_prepared);
+            CassStatement* statement = cass_prepared_bind(prepared.get(), m_num_args);
+            if (!statement)
+            {
+                throw Exception(std::string("failed binding statement for ") + m_name + ": " + m_query,
+                                 __FILE__, __LINE__);
+            }
+            cass_statement_set_consistency(statement, m_consist);
+
+            try
+            {
+                bind_all(statement, Fargs...);
+            } catch(...)
+            {
+                cass_statement_free(statement);
+                throw;
+            }
+            return statement;
+        }
+
+        // rough size of the bound values on the wire, used to cap batch sizes
+        template<typename T, typename... Targs>
+        static size_t bound_size(const T& value, const Targs&... Fargs)
+        {
+            return 4 + value_size(value) + bound_size(Fargs...);
+        }
+
+        static size_t bound_size()
+        {
+            return 0;
+        }
+
+        // fixed size values
+        template<typename T>
+        static size_t value_size(const T& val)
+        {
+            return sizeof(val);
+        }
+        static size_t value_size(const CassString& val)
+        {
+            return val.length;
+        }
+        static size_t value_size(const std::string& val)
+        {
+            return val.size();
+        }
+        static size_t value_size(const char* val)
+        {
+            return val ? strlen(val) : 0;
+        }
+#if __cplusplus >= 201703L
+        static size_t value_size(const std::string_view& val)
+        {
+            return val.size();
+        }
+#endif
+        static size_t value_size(const CassBytes& val)
+        {
+            return val.size;
+        }
+        static size_t value_size(const std::vector<cass_byte_t>& val)
+        {
+            return val.size();
+        }
+        static size_t value_size(const CassBytesMgr& val)
+        {
+            return val.size();
+        }
+        static size_t value_size(const cb::RefId& val)
+        {
+            return CASS_UUID_NUM_BYTES;
+        }
+        static size_t value_size(const CassInet& val)
+        {
+            return val.address_length;
+        }
+        static size_t value_size(const CassDecimal& val)
+        {
+            return 4 + val.varint.size;
+        }
+        static size_t value_size(const NullBinder& val)
+        {
+            return 0;
+        }
+        template<typename C>
+        static size_t items_size(const C& val)
+        {
+            size_t retVal = 4;
+            for (auto it = val.begin(); it != val.end(); ++it)
+            {
+                retVal += 4 + value_size(*it);
+            }
+            return retVal;
+        }
+        template<typename T>
+        static size_t value_size(const std::vector<T>& val)
+        {
+            return items_size(val);
+        }
+        template<typename T>
+        static size_t value_size(const std::list<T>& val)
+        {
+            return items_size(val);
+        }
+        template<typename T>
+        static size_t value_size(const std::set<T>& val)
+        {
+            return items_size(val);
+        }
+        template<typename T>
+        static size_t value_size(const std::deque<T>& val)
+        {
+            return items_size(val);
+        }
+        template<typename T, size_t N>
+        static size_t value_size(const std::array<T, N>& val)
+        {
+            return items_size(val);
+        }
+        template<typename T>
+        static size_t value_size(const std::unordered_set<T>& val)
+        {
+            return items_size(val);
+        }
+        template<typename It>
+        static size_t pairs_size(It begin, It end)
+        {
+            size_t retVal = 4;
+            for (It it = begin; it != end; ++it)
+            {
+                retVal += 8 + value_size(it->first) + value_size(it->second);
+            }
+            return retVal;
+        }
+        template<typename T, typename S>
+        static size_t value_size(const std::map<S,T>& val)
+        {
+            return pairs_size(val.begin(), val.end());
+        }
+        template<typename T, typename S>
+        static size_t value_size(const std::unordered_map<S,T>& val)
+        {
+            return pairs_size(val.begin(), val.end());
+        }
+        template<typename It>
+        static size_t value_size(const CollectionRange<It>& val)
+        {
+            return items_size(val);
+        }
+        template<typename It>
+        static size_t value_size(const MapRange<It>& val)
+        {
+            return pairs_size(val.m_begin, val.m_end);
+        }
+
+        bool do_bind(CassStatement* statement, unsigned index, const cass_int32_t& val)
+        {
+            return cass_statement_bind_int32(statement, index, val) == CASS_OK;
+        }
+
+        bool do_bind(CassStatement* statement, unsigned index, const cass_int64_t& val)
+        {
+            return cass_statement_bind_int64(statement, index, val) == CASS_OK;
+        }
+
+        bool do_bind(CassStatement* statement, unsigned index, const cass_float_t& val)
+        {
+            return cass_statement_bind_float(statement, index, val) == CASS_OK;
+        }
+
+        bool do_bind(CassStatement* statement, unsigned index, const cass_double_t& val)
+        {
+            return cass_statement_bind_double(statement, index, val) == CASS_OK;
+        }
+
+        bool do_bind(CassStatement* statement, unsigned index, const bool& val_in)
+        {
+            cass_bool_t val = val_in ? cass_true : cass_false;
+            return cass_statement_bind_bool(statement, index, val) == CASS_OK;
+        }
+
+        bool do_bind(CassStatement* statement, unsigned index, const CassString& val)
+        {
+            return cass_statement_bind_string(statement, index, val) == CASS_OK;
+        }
+
+        bool do_bind(CassStatement* statement, unsigned index, const std::string& val_in)
+        {
+            CassString val;
+            val.length = val_in.size();
+            if (val.length)
+            {
+                val.data = val_in.c_str();
+            } else
+            {
+                val.data = 0;
+            }
+            return cass_statement_bind_string(statement, index, val) == CASS_OK;
+        }
+
+        // null binds a null
+        bool do_bind(CassStatement* statement, unsigned index, const char* val)
+        {
+            if (!val)
+            {
+                return cass_statement_bind_null(statement, index) == CASS_OK;
+            }
+            return cass_statement_bind_string(statement, index, cass_string_init(val)) == CASS_OK;
+        }
+
+#if __cplusplus >= 201703L
+        bool do_bind(CassStatement* statement, unsigned index, const std::string_view& val)
+        {
+            return cass_statement_bind_string(statement, index, 
+                                              cass_string_init2(val.data(), val.size())) == CASS_OK;
+        }
+#endif
+
+        bool do_bind(CassStatement* statement, unsigned index, const CassBytes& val)
+        {
+            return cass_statement_bind_bytes(statement, index, val) == CASS_OK;
+        }
+
+        bool do_bind(CassStatement* statement, unsigned index, const std::vector<cass_byte_t>& val_in)
+        {
+            CassBytes val;
+            val.size = val_in.size();
+            if (val.size)
+            {
+                val.data = &val_in.front();
+            } else
+            {
+                val.data = 0;
+            }
+            return cass_statement_bind_bytes(statement, index, val) == CASS_OK;
+        }
+
+        bool do_bind(CassStatement* statement, unsigned index, const CassBytesMgr& val_in)
+        {
+            return cass_statement_bind_bytes(statement, index, val_in.view()) == CASS_OK;
+        }
+
+
+        bool do_bind(CassStatement* statement, unsigned index, const CassUuid& val)
+        {
+            return cass_statement_bind_uuid(statement, index, val) == CASS_OK;
+        }
+
+        bool do_bind(CassStatement* statement, unsigned index, const cb::RefId& val)
+        {
+            return cass_statement_bind_uuid(statement, index, val.get_uuid()) == CASS_OK;
+        }
+
+        bool do_bind(CassStatement* statement, unsigned index, const CassInet& val)
+        {
+            return cass_statement_bind_inet(statement, index, val) == CASS_OK;
+        }
+
+        bool do_bind(CassStatement* statement, unsigned index, const CassDecimal& val)
+        {
+            return cass_statement_bind_decimal(statement, index, val) == CASS_OK;
+        }
+
+        bool do_bind(CassStatement* statement, unsigned index, const CassCollection*& val)
+        {
+            return cass_statement_bind_collection(statement, index, val) == CASS_OK;
+        }
+
+        // all these do_append there to support standard std containers
+        bool do_append(CassCollection* coll_ptr, const cass_int32_t& val)
+        {
+            return cass_collection_append_int32(coll_ptr, val) == CASS_OK;
+        }
+        bool do_append(CassCollection* coll_ptr, const cass_int64_t& val)
+        {
+            return cass_collection_append_int64(coll_ptr, val) == CASS_OK;
+        }
+        bool do_append(CassCollection* coll_ptr, const cass_float_t& val)
+        {
+            return cass_collection_append_float(coll_ptr, val) == CASS_OK;
+        }
+        bool do_append(CassCollection* coll_ptr, const cass_double_t& val)
+        {
+            return cass_collection_append_double(coll_ptr, val) == CASS_OK;
+        }
+        bool do_append(CassCollection* coll_ptr, const cass_bool_t& val)
+        {
+            return cass_collection_append_bool(coll_ptr, val) == CASS_OK;
+        }
+        bool do_append(CassCollection* coll_ptr, const bool& val_in)
+        {
+            cass_bool_t val = val_in ? cass_true : cass_false;
+            return cass_collection_append_bool(coll_ptr, val) == CASS_OK;
+        }
+        bool do_append(CassCollection* coll_ptr, const CassString& val)
+        {
+            return cass_collection_append_string(coll_ptr, val) == CASS_OK;
+        }
+        bool do_append(CassCollection* coll_ptr, const std::string& val_in)
+        {
+            CassString val;
+            val.length = val_in.size();
+            if (val.length)
+            {
+                val.data = val_in.c_str();
+            } else
+            {
+                val.data = 0;
+            }
+            return cass_collection_append_string(coll_ptr, val) == CASS_OK;
+        }
+        bool do_append(CassCollection* coll_ptr, const CassBytes& val)
+        {
+            return cass_collection_append_bytes(coll_ptr, val) == CASS_OK;
+        }
+        bool do_append(CassCollection* coll_ptr, const std::vector<cass_byte_t>& val_in)
+        {
+            CassBytes val;
+            val.size = val_in.size();
+            if (val.size)
+            {
+                val.data = &val_in.front();
+            } else
+            {
+                val.data = 0;
+            }
+            return cass_collection_append_bytes(coll_ptr, val) == CASS_OK;
+        }
+        bool do_append(CassCollection* coll_ptr, const CassBytesMgr& val)
+        {
+            return cass_collection_append_bytes(coll_ptr, val.view()) == CASS_OK;
+        }
+        bool do_append(CassCollection* coll_ptr, const char* val)
+        {
+            return cass_collection_append_string(coll_ptr, cass_string_init(val)) == CASS_OK;
+        }
+#if __cplusplus >= 201703L
+        bool do_append(CassCollection* coll_ptr, const std::string_view& val)
+        {
+            return cass_collection_append_string(coll_ptr, cass_string_init2(val.data(), val.size())) == CASS_OK;
+        }
+#endif
+        bool do_append(CassCollection* coll_ptr, const CassUuid& val)
+        {
+            // could be a dangerous const cast
+            return cass_collection_append_uuid(coll_ptr, const_cast<CassUuid&>(val)) == CASS_OK;
+        }
+        bool do_append(CassCollection* coll_ptr, const cb::RefId& val)
+        {
+            return do_append(coll_ptr, val.get_uuid());
+        }
+        bool do_append(CassCollection* coll_ptr, const CassInet& val)
+        {
+            return cass_collection_append_inet(coll_ptr, val) == CASS_OK;
+        }
+        bool do_append(CassCollection* coll_ptr, const CassDecimal& val)
+        {
+            return cass_collection_append_decimal(coll_ptr, val) == CASS_OK;
+        }
+
+        // appends [begin, end) and binds it. num_items presizes the collection.
+        template<typename It>
+        bool bind_collection(CassStatement* statement, unsigned index, CassCollectionType type,
+                             It begin, It end, size_t num_items)
+        {
+            CassCollection* coll_ptr = cass_collection_new(type, num_items);
+            bool retVal = coll_ptr != 0;
+            if (coll_ptr)
+            {
+                for (It it = begin; it != end && retVal; ++it)
+                {
+                    retVal = do_append(coll_ptr, *it);
+                }
+                if (retVal)
+                {
+                    retVal = cass_statement_bind_collection(statement, index, coll_ptr) == CASS_OK;
+                }
+                cass_collection_free(coll_ptr);
+            }
+            return retVal;
+        }
+
+        // same for a range of pairs, key and value are appended as 2 items.
+        template<typename It>
+        bool bind_map(CassStatement* statement, unsigned index, It begin, It end, size_t num_pairs)
+        {
+            CassCollection* coll_ptr = cass_collection_new(CASS_COLLECTION_TYPE_MAP, 2 * num_pairs);
+            bool retVal = coll_ptr != 0;
+            if (coll_ptr)
+            {
+                for (It it = begin; it != end && retVal; ++it)
+                {
+                    retVal = do_append(coll_ptr, it->first) && do_append(coll_ptr, it->second);
+                }
+                if (retVal)
+                {
+                    retVal = cass_statement_bind_collection(statement, index, coll_ptr) == CASS_OK;
+                }
+                cass_collection_free(coll_ptr);
+            }
+            return retVal;
+        }
+
+        template<typename T>
+        bool do_bind(CassStatement* statement, unsigned index, const std::vector<T>& val)
+        {
+            return bind_collection(statement, index, CASS_COLLECTION_TYPE_LIST, val.begin(), val.end(), val.size());
+        }
+
+        template<typename T>
+        bool do_bind(CassStatement* statement, unsigned index, const std::list<T>& val)
+        {
+            return bind_collection(statement, index, CASS_COLLECTION_TYPE_LIST, val.begin(), val.end(), val.size());
+        }
+
+        template<typename T>
+        bool do_bind(CassStatement* statement, unsigned index, const std::deque<T>& val)
+        {
+            return bind_collection(statement, index, CASS_COLLECTION_TYPE_LIST, val.begin(), val.end(), val.size());
+        }
+
+        template<typename T, size_t N>
+        bool do_bind(CassStatement* statement, unsigned index, const std::array<T, N>& val)
+        {
+            return bind_collection(statement, index, CASS_COLLECTION_TYPE_LIST, val.begin(), val.end(), N);
+        }
+
+        template<typename T>
+        bool do_bind(CassStatement* statement, unsigned index, const std::set<T>& val)
+        {
+            return bind_collection(statement, index, CASS_COLLECTION_TYPE_SET, val.begin(), val.end(), val.size());
+        }
+
+        template<typename T>
+        bool do_bind(CassStatement* statement, unsigned index, const std::unordered_set<T>& val)
+        {
+            return bind_collection(statement, index, CASS_COLLECTION_TYPE_SET, val.begin(), val.end(), val.size());
+        }
+
+        template<typename T, typename S>
+        bool do_bind(CassStatement* statement, unsigned index, const std::map<S,T>& val)
+        {
+            return bind_map(statement, index, val.begin(), val.end(), val.size());
+        }
+
+        template<typename T, typename S>
+        bool do_bind(CassStatement* statement, unsigned index, const std::unordered_map<S,T>& val)
+        {
+            return bind_map(statement, index, val.begin(), val.end(), val.size());
+        }
+
+        template<typename It>
+        bool do_bind(CassStatement* statement, unsigned index, const CollectionRange<It>& val)
+        {
+            return bind_collection(statement, index, val.m_type, val.m_begin, val.m_end, val.m_size);
+        }
+
+        template<typename It>
+        bool do_bind(CassStatement* statement, unsigned index, const MapRange<It>& val)
+        {
+            return bind_map(statement, index, val.m_begin, val.m_end, val.m_size);
+        }
+
+        bool do_bind(CassStatement* statement, unsigned index, const NullBinder& val)
+        {
+            return cass_statement_bind_null(statement, index) == CASS_OK;
+        }
+
+        // binds Fargs to index 0, 1, ... as one flat sequence of do_bind calls.
+        // Throws on the first one which fails.
+        template<typename... Targs>
+        void bind_all(CassStatement* statement, const Targs&... Fargs)
+        {
+            unsigned index = 0;
+            bool ok = true;
+            // braced init list runs left to right
+            int expand[] = { 0, bind_next(statement, index, ok, Fargs)... };
+            (void) expand;
+            if (!ok)
+            {
+                std::ostringstream err;
+                err << "failed binding index: " << index << "/" << m_num_args << " for " << m_name << ": " 
+                    << m_query.c_str();
+                throw Exception(err.str(), __FILE__, __LINE__);
+            }
+        }
+
+        // index is left on the failed value once ok is false
+        template<typename T>
+        int bind_next(CassStatement* statement, unsigned& index, bool& ok, const T& value)
+        {
+            if (ok)
+            {
+                ok = do_bind(statement, index, value);
+                if (ok)
+                {
+                    ++index;
+                }
+            }
+            return 0;
+        }
+
+        const char* m_name;
+        std::string m_query;
+
+        // only accessed with std::atomic_load/atomic_store, since reprepare can
+        // swap it while other threads are binding from it.
+        std::shared_ptr<const CassPrepared> m_prepared;
+        unsigned m_num_args;
+        CassConsistency m_consist;
+        cass_duration_t m_timeout_in_micro;
+    };
+}
+
+#endif 
+
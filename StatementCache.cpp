@@ -0,0 +1,92 @@
+#include "cql-interface/StatementCache.h"
+
+using namespace cb;
+using namespace std;
+
+StatementCache::StatementCache(size_t max_entries)
+: m_max_entries(max_entries),
+  m_hit(0),
+  m_miss(0),
+  m_evict(0)
+{
+}
+
+void StatementCache::set_max_entries(size_t max_entries)
+{
+    lock_guard<mutex> guard(m_mutex);
+    m_max_entries = max_entries;
+    evict(max_entries);
+}
+
+StatementCache::EntryPtr StatementCache::find(const std::string& key)
+{
+    lock_guard<mutex> guard(m_mutex);
+    auto it = m_entries.find(key);
+    if (it == m_entries.end())
+    {
+        m_miss.fetch_add(1);
+        return EntryPtr();
+    }
+    m_hit.fetch_add(1);
+    m_lru.splice(m_lru.begin(), m_lru, it->second);
+    return *it->second;
+}
+
+void StatementCache::insert(EntryPtr entry)
+{
+    if (!entry)
+    {
+        return;
+    }
+    lock_guard<mutex> guard(m_mutex);
+    size_t max_entries = m_max_entries;
+    if (!max_entries)
+    {
+        return;
+    }
+    auto it = m_entries.find(entry->m_key);
+    if (it != m_entries.end())
+    {
+        *it->second = entry;
+        m_lru.splice(m_lru.begin(), m_lru, it->second);
+        return;
+    }
+    evict(max_entries - 1);
+    m_lru.push_front(entry);
+    m_entries[entry->m_key] = m_lru.begin();
+}
+
+void StatementCache::erase(const std::string& key)
+{
+    lock_guard<mutex> guard(m_mutex);
+    auto it = m_entries.find(key);
+    if (it != m_entries.end())
+    {
+        m_lru.erase(it->second);
+        m_entries.erase(it);
+    }
+}
+
+size_t StatementCache::size()
+{
+    lock_guard<mutex> guard(m_mutex);
+    return m_entries.size();
+}
+
+void StatementCache::take_stats(uint64_t& hit, uint64_t& miss, uint64_t& evict)
+{
+    hit = m_hit.exchange(0);
+    miss = m_miss.exchange(0);
+    evict = m_evict.exchange(0);
+}
+
+void StatementCache::evict(size_t max_entries)
+{
+    while (m_entries.size() > max_entries)
+    {
+        m_entries.erase(m_lru.back()->m_key);
+        m_lru.pop_back();
+        m_evict.fetch_add(1);
+    }
+}
+
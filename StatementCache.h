@@ -0,0 +1,95 @@
+#ifndef CB_STATEMENT_CACHE_H
+#define CB_STATEMENT_CACHE_H
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <cassandra.h>
+
+namespace cb {
+
+    // bounded LRU of prepared statements, keyed on CqlTemplate::key().
+    // Used by CassConn to run text queries through prepared statements.
+    class StatementCache
+    {
+    public:
+
+        struct Entry
+        {
+            Entry(const std::string& key, const CassPrepared* prepared)
+            : m_key(key),
+              m_prepared(prepared)
+            {
+            }
+
+            ~Entry()
+            {
+                if (m_prepared)
+                {
+                    cass_prepared_free(m_prepared);
+                }
+            }
+
+            const std::string m_key;
+
+            // null if this query shape can't be prepared, so run it as text
+            const CassPrepared* const m_prepared;
+        };
+        typedef std::shared_ptr<Entry> EntryPtr;
+
+        // max_entries == 0 means the cache is off
+        explicit StatementCache(size_t max_entries = 0);
+
+        bool enabled() const
+        {
+            return m_max_entries.load() > 0;
+        }
+
+        // evicts down to max_entries if needed
+        void set_max_entries(size_t max_entries);
+
+        // returns null and counts a miss if key is not present
+        EntryPtr find(const std::string& key);
+
+        // adds or replaces the entry for entry->m_key
+        void insert(EntryPtr entry);
+
+        // drop key, say after the server no longer knows the prepared id
+        void erase(const std::string& key);
+
+        size_t size();
+
+        uint64_t hits() const { return m_hit.load(); }
+        uint64_t misses() const { return m_miss.load(); }
+        uint64_t evictions() const { return m_evict.load(); }
+
+        // gets the counters and clears them
+        void take_stats(uint64_t& hit, uint64_t& miss, uint64_t& evict);
+
+    private:
+
+        StatementCache(const StatementCache&) = delete;
+        StatementCache& operator=(const StatementCache&) = delete;
+
+        // must hold m_mutex
+        void evict(size_t max_entries);
+
+        typedef std::list<EntryPtr> LruList;       // most recently used in front
+        typedef std::unordered_map<std::string, LruList::iterator> EntryMap;
+
+        std::mutex m_mutex;
+        LruList m_lru;
+        EntryMap m_entries;
+        std::atomic<size_t> m_max_entries;
+
+        std::atomic<uint64_t> m_hit;
+        std::atomic<uint64_t> m_miss;
+        std::atomic<uint64_t> m_evict;
+    };
+}
+
+#endif
+
@@ -0,0 +1,173 @@
+#include "cql-interface/StoreHolder.h"
+#include "cql-interface/CassConn.h"
+
+using namespace cb;
+
+StoreHolder::~StoreHolder()
+{
+    free_future();
+}
+
+void StoreHolder::free_future()
+{
+    if (m_future)
+    {
+        cass_future_free(m_future);
+        m_future = 0;
+    }
+}
+
+void StoreHolder::clear()
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    free_future();
+    m_was_called = true;    // no need to call again
+    m_result = false;
+    m_was_unprepared = false;
+    m_error_code = CASS_OK;
+    m_timed_out = false;
+    m_query.clear();
+    m_timeout_in_micro = 0;
+    m_callback = Callback();
+}
+
+void StoreHolder::set_result(bool result)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    free_future();
+    m_was_called = true;
+    m_result = result;
+    m_was_unprepared = false;
+    m_error_code = CASS_OK;
+    m_timed_out = false;
+    m_query.clear();
+    m_timeout_in_micro = 0;
+    m_callback = Callback();
+}
+
+bool StoreHolder::assign(CassFuture* future, 
+                         const std::string& query,
+                         cass_duration_t timeout_in_micro)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    free_future();
+    m_callback = Callback();
+    m_result = false;
+    m_was_unprepared = false;
+    m_error_code = CASS_OK;
+    m_timed_out = false;
+    if (future)
+    {
+        m_was_called = false;
+        m_future = future;
+        m_query = query;
+        m_timeout_in_micro = timeout_in_micro;
+        return true;
+    }
+    m_was_called = true;
+    m_query.clear();
+    m_timeout_in_micro = 0;
+    return false;
+}
+
+bool StoreHolder::process()
+{
+    if (m_future && !m_was_called)
+    {
+        m_was_called = true;
+        m_result = CassConn::process_store_future(m_future, m_query, m_timeout_in_micro, 
+                                                  &m_was_unprepared);
+        if (!m_result)
+        {
+            // not ready after process_store_future waited means a local timeout
+            m_error_code = cass_future_ready(m_future) ? cass_future_error_code(m_future) : CASS_OK;
+            m_timed_out = (m_error_code == CASS_OK);
+        }
+    }
+    return m_result;
+}
+
+bool StoreHolder::wait()
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    return process();
+}
+
+bool StoreHolder::was_unprepared()
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    return m_was_unprepared;
+}
+
+CassError StoreHolder::error_code()
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    return m_error_code;
+}
+
+bool StoreHolder::timed_out()
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    return m_timed_out;
+}
+
+bool StoreHolder::is_ready()
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    return !m_future || m_was_called || cass_future_ready(m_future);
+}
+
+bool StoreHolder::on_complete(Callback callback)
+{
+    CassFuture* future = 0;
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        if (!m_future || m_was_called)
+        {
+            future = 0;
+        } else
+        {
+            m_callback = callback;
+            future = m_future;
+        }
+    }
+    if (!future)
+    {
+        // nothing in flight, so report what we have
+        callback(wait());
+        return true;
+    }
+
+    // the driver holds a reference to this until complete is called.
+    // If the future is already done the driver calls complete right away,
+    // so do this without the lock.
+    StoreHolderPtr* self = new StoreHolderPtr(shared_from_this());
+    if (cass_future_set_callback(future, &StoreHolder::complete, self) != CASS_OK)
+    {
+        delete self;
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_callback = Callback();
+        return false;
+    }
+    return true;
+}
+
+void StoreHolder::complete(CassFuture* future, void* data)
+{
+    StoreHolderPtr* self = static_cast<StoreHolderPtr*>(data);
+    Callback callback;
+    bool result = false;
+    {
+        std::lock_guard<std::mutex> guard((*self)->m_mutex);
+        if ((*self)->m_future == future)
+        {
+            result = (*self)->process();
+            callback.swap((*self)->m_callback);
+        }
+    }
+    if (callback)
+    {
+        callback(result);
+    }
+    delete self;
+}
@@ -0,0 +1,99 @@
+#ifndef CB_STORE_HOLDER_H
+#define CB_STORE_HOLDER_H
+
+#include <functional>
+#include <mutex>
+#include <string>
+#include <boost/shared_ptr.hpp>
+#include <boost/enable_shared_from_this.hpp>
+#include <cassandra.h>
+
+namespace cb {
+
+    // holds a store in a async context, the store side of CassFetcherHolder.
+    // Wait on it, poll it with is_ready, or give it a callback with on_complete.
+    class StoreHolder : public boost::enable_shared_from_this<StoreHolder>
+    {
+    public:
+
+        // called with the store result, from a driver thread
+        typedef std::function<void(bool)> Callback;
+
+        StoreHolder()
+        : m_future(0),
+          m_timeout_in_micro(0),
+          m_was_called(true),
+          m_result(false),
+          m_was_unprepared(false),
+          m_error_code(CASS_OK),
+          m_timed_out(false)
+        {
+        }
+
+        ~StoreHolder();
+
+        // set this Holder with some contents. Takes ownership of the future.
+        bool assign(CassFuture* future, 
+                    const std::string& query,
+                    cass_duration_t timeout_in_micro);
+
+        // will wait for the future to complete (if necessary) and
+        // returns true if the store worked.
+        bool wait();
+
+        // true if wait will not block
+        bool is_ready();
+
+        // once the store is done, true if it failed because the server no longer
+        // knows the prepared id (node restart or schema change). Async stores can't
+        // prepare again on their own like PreparedStore::store, so call
+        // PreparedStatement::reprepare and store again.
+        bool was_unprepared();
+
+        // once the store is done, the driver error it failed with, CASS_OK if it
+        // worked or timed out before the server answered
+        CassError error_code();
+
+        // once the store is done, true if it failed with a local timeout. The
+        // server may still apply it.
+        bool timed_out();
+
+        // callback is called once the store completes, or right away if it
+        // already has. Holds a reference to this until then.
+        // Keep the callback short, it runs on a driver thread.
+        bool on_complete(Callback callback);
+
+        // clears out current contents
+        void clear();
+
+        // done with result and nothing in flight, for a store with nothing to send
+        void set_result(bool result);
+
+    private:
+
+        StoreHolder(const StoreHolder&) = delete;
+        StoreHolder& operator=(const StoreHolder&) = delete;
+
+        // must hold m_mutex
+        bool process();
+        void free_future();
+
+        static void complete(CassFuture* future, void* data);
+
+        std::mutex m_mutex;
+        CassFuture* m_future;
+        std::string m_query;
+        cass_duration_t m_timeout_in_micro;
+        Callback m_callback;
+
+        bool m_was_called;
+        bool m_result;
+        bool m_was_unprepared;
+        CassError m_error_code;
+        bool m_timed_out;
+    };
+    typedef boost::shared_ptr<StoreHolder> StoreHolderPtr;
+}
+
+#endif 
+
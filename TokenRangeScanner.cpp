@@ -0,0 +1,138 @@
+#include <atomic>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include "log4cxx/logger.h"
+
+#include "cql-interface/TokenRangeScanner.h"
+#include "cql-interface/WorkerPool.h"
+#include "cql-interface/CassConn.h"
+#include "cql-interface/PreparedFetch.h"
+
+using namespace cb;
+using namespace std;
+
+namespace {
+    log4cxx::LoggerPtr logger(log4cxx::Logger::getLogger("cb.token_range_scanner"));
+}
+
+TokenRangeScanner::TokenRangeScanner(const std::string& table, 
+                                     const std::string& partition_key,
+                                     const std::string& columns)
+: m_num_ranges(0),
+  m_num_workers(4),
+  m_page_size(1000)
+{
+    m_query = "select " + columns + " from " + table 
+                + " where token(" + partition_key + ") > ?"
+                + " and token(" + partition_key + ") <= ?";
+}
+
+std::vector<TokenRangeScanner::TokenRange> TokenRangeScanner::split_ring(unsigned num_ranges)
+{
+    if (!num_ranges)
+    {
+        num_ranges = 1;
+    }
+    // work in unsigned offsets from the min token, the ring is 2^64 wide
+    const uint64_t min_token = uint64_t(numeric_limits<int64_t>::min());
+    const uint64_t step = numeric_limits<uint64_t>::max() / num_ranges;
+
+    vector<TokenRange> retVal;
+    retVal.reserve(num_ranges);
+    uint64_t start = 0;
+    for (unsigned i = 0; i < num_ranges; ++i)
+    {
+        uint64_t end = (i + 1 == num_ranges ? numeric_limits<uint64_t>::max() : start + step);
+        retVal.push_back(TokenRange(int64_t(min_token + start), int64_t(min_token + end)));
+        start = end;
+    }
+    return retVal;
+}
+
+bool TokenRangeScanner::fetch_range(PreparedFetch& prep_fetch, CassFetcher& fetcher, const TokenRange& range)
+{
+    // a throwing fetcher fails just this range, the worker goes on to the next
+    try
+    {
+        if (prep_fetch.fetch_paged(fetcher, m_page_size, 0, 
+                                   cass_int64_t(range.first), 
+                                   cass_int64_t(range.second)))
+        {
+            return true;
+        }
+        LOG4CXX_ERROR(logger, "failed scanning range (" << range.first << ", " 
+                                << range.second << "] for: " << m_query);
+    } catch(std::exception& e)
+    {
+        LOG4CXX_ERROR(logger, "exception scanning range (" << range.first << ", " 
+                                << range.second << "] for: " << m_query << ": " << e.what());
+    }
+    return false;
+}
+
+bool TokenRangeScanner::scan(FetcherFactory factory, Reduce reduce)
+{
+    m_summary = Summary();
+
+    PreparedFetchPtr prep_fetch = CassConn::prepare_fetch(m_query, 2);
+    if (!prep_fetch)
+    {
+        LOG4CXX_ERROR(logger, "failed preparing scan: " << m_query);
+        return false;
+    }
+
+    vector<TokenRange> ranges = split_ring(m_num_ranges ? m_num_ranges : 16 * m_num_workers);
+    atomic<size_t> next_range(0);
+    atomic<uint64_t> num_failed(0);
+    mutex reduce_mutex;
+
+    {
+        WorkerPool pool(m_num_workers);
+        for (unsigned worker = 0; worker < m_num_workers; ++worker)
+        {
+            pool.post([&, worker]()
+            {
+                // WorkerPool only logs what a task throws, so count it here
+                try
+                {
+                    CassFetcherPtr fetcher = factory(worker);
+                    if (!fetcher)
+                    {
+                        LOG4CXX_ERROR(logger, "null fetcher for worker " << worker << " on scan: " << m_query);
+                        num_failed.fetch_add(1);
+                        return;
+                    }
+                    for (size_t i = next_range.fetch_add(1); i < ranges.size(); i = next_range.fetch_add(1))
+                    {
+                        if (!fetch_range(*prep_fetch, *fetcher, ranges[i]))
+                        {
+                            num_failed.fetch_add(1);
+                        }
+                    }
+                    if (reduce)
+                    {
+                        lock_guard<mutex> guard(reduce_mutex);
+                        reduce(worker, *fetcher);
+                    }
+                } catch(std::exception& e)
+                {
+                    LOG4CXX_ERROR(logger, "exception in worker " << worker << " on scan: " << m_query
+                                            << ": " << e.what());
+                    num_failed.fetch_add(1);
+                } catch(...)
+                {
+                    LOG4CXX_ERROR(logger, "unknown exception in worker " << worker << " on scan: " << m_query);
+                    num_failed.fetch_add(1);
+                }
+            });
+        }
+        pool.wait();
+    }
+
+    m_summary.m_ranges = ranges.size();
+    m_summary.m_failed = num_failed;
+    LOG4CXX_DEBUG(logger, "scanned " << ranges.size() << " ranges with " << m_num_workers 
+                            << " workers, " << m_summary.m_failed << " failed: " << m_query);
+    return m_summary.m_failed == 0;
+}
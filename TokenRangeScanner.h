@@ -0,0 +1,89 @@
+#ifndef CB_TOKEN_RANGE_SCANNER_H
+#define CB_TOKEN_RANGE_SCANNER_H
+
+#include <stdint.h>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+#include "cql-interface/CassFetcher.h"
+
+namespace cb {
+
+    class PreparedFetch;
+
+    // scans a whole table in parallel. The Murmur3 ring is split into num_ranges
+    // token ranges, and num_workers threads each take the next range and run
+    //
+    //     select <columns> from <table> where token(<partition_key>) > ? and token(<partition_key>) <= ?
+    //
+    // through fetch_paged. Every worker has its own fetcher from the factory, so
+    // fetchers need no locking. Once a worker is done, reduce is called with its
+    // fetcher, one worker at a time.
+    //
+    //     TokenRangeScanner scanner("partition_data", "part_key", "item, value");
+    //     scanner.scan([](unsigned worker) { return CassFetcherPtr(new MyFetcher()); },
+    //                  [&](unsigned worker, CassFetcher& fetcher) { total += ...; });
+    class TokenRangeScanner
+    {
+    public:
+
+        typedef std::function<CassFetcherPtr(unsigned worker)> FetcherFactory;
+        typedef std::function<void(unsigned worker, CassFetcher& fetcher)> Reduce;
+
+        // (start, end] token ranges
+        typedef std::pair<int64_t, int64_t> TokenRange;
+
+        struct Summary
+        {
+            uint64_t m_ranges = 0;       // ranges scanned
+            uint64_t m_failed = 0;       // ranges which failed to fetch
+        };
+
+        // partition_key is the column list given to token(), so "a, b" for a composite key
+        TokenRangeScanner(const std::string& table, 
+                          const std::string& partition_key,
+                          const std::string& columns = "*");
+
+        // ranges to split the ring into, defaults to 16 per worker
+        void set_num_ranges(unsigned num_ranges)
+        {
+            m_num_ranges = num_ranges;
+        }
+
+        void set_num_workers(unsigned num_workers)
+        {
+            m_num_workers = num_workers ? num_workers : 1;
+        }
+
+        void set_page_size(unsigned page_size)
+        {
+            m_page_size = page_size ? page_size : 1;
+        }
+
+        // returns true if every range was fetched
+        bool scan(FetcherFactory factory, Reduce reduce = Reduce());
+
+        const Summary& summary() const
+        {
+            return m_summary;
+        }
+
+        // splits the full ring into num_ranges contiguous ranges
+        static std::vector<TokenRange> split_ring(unsigned num_ranges);
+
+    private:
+
+        // fetches one range, false if it failed or threw
+        bool fetch_range(PreparedFetch& prep_fetch, CassFetcher& fetcher, const TokenRange& range);
+
+        std::string m_query;
+        unsigned m_num_ranges;
+        unsigned m_num_workers;
+        unsigned m_page_size;
+        Summary m_summary;
+    };
+}
+
+#endif 
+
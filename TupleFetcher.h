@@ -0,0 +1,178 @@
+#ifndef CB_TUPLE_FETCHER_H
+#define CB_TUPLE_FETCHER_H
+
+#include <tuple>
+#include <vector>
+#include "cql-interface/FetchHelper.h"
+#include "cql-interface/CassConn.h"
+#include "cql-interface/PreparedFetch.h"
+
+namespace cb {
+
+    // maps the columns of a row onto a Row object. Specialize this for your own
+    // structs, listing the members in select order:
+    //
+    //     namespace cb {
+    //         template<> struct RowMapper<DocPair>
+    //         {
+    //             static bool get(DocPair& obj, const CassRow& row)
+    //             {
+    //                 return FetchHelper::get_columns(row, obj.docid, obj.value);
+    //             }
+    //         };
+    //     }
+    //
+    // std::tuple of types known to FetchHelper is already mapped, column i to element i.
+    template <typename Row>
+    struct RowMapper;
+
+    template <typename... Ts>
+    struct RowMapper<std::tuple<Ts...>>
+    {
+        static bool get(std::tuple<Ts...>& obj, const CassRow& row)
+        {
+            return get_from<0>(obj, row);
+        }
+
+    private:
+
+        template <size_t I>
+        static typename std::enable_if<I == sizeof...(Ts), bool>::type 
+        get_from(std::tuple<Ts...>& obj, const CassRow& row)
+        {
+            return true;
+        }
+
+        template <size_t I>
+        static typename std::enable_if<I < sizeof...(Ts), bool>::type 
+        get_from(std::tuple<Ts...>& obj, const CassRow& row)
+        {
+            return FetchHelper::get_nth(I, std::get<I>(obj), row) && get_from<I + 1>(obj, row);
+        }
+    };
+
+    // fetch a single row result into a Row with a RowMapper, 
+    // like Fetcher does for one column.
+    // returns true if a row was obtained, otherwise false
+    template <typename Row>
+    class RowFetcher : public CassFetcher
+    {
+    public:
+
+        virtual ~RowFetcher() {}
+
+        bool do_fetch(const std::string& query, Row& obj)
+        {
+            m_was_set = false;
+            m_ptr = &obj;
+            return CassConn::fetch(query, *this) && m_was_set;
+        }
+
+        // if timeout_in_micro == 0, will use global timeout default set in CassConn
+        bool do_fetch(const std::string& query, 
+                      Row& obj, 
+                      CassConsistency consist,
+                      cass_duration_t timeout_in_micro = 0)
+        {
+            m_was_set = false;
+            m_ptr = &obj;
+            return CassConn::fetch(query, *this, consist, timeout_in_micro) && m_was_set;
+        }
+
+        // fetch with a prepared select, binding Fargs. 
+        // will throw if there is an issue binding values.
+        template<typename... Targs>
+        bool do_fetch(PreparedFetch& prep_fetch, Row& obj, const Targs&... Fargs)
+        {
+            m_was_set = false;
+            m_ptr = &obj;
+            return prep_fetch.fetch(*this, Fargs...) && m_was_set;
+        }
+
+    protected:
+
+        virtual bool fetch(const CassRow& result)
+        {
+            m_was_set = true;
+            return RowMapper<Row>::get(*m_ptr, result);
+        }
+
+        Row* m_ptr;
+        bool m_was_set;
+    };
+
+    // fetch many rows, each one mapped with a RowMapper straight into a new
+    // element at the end of con, so there is no copy per row.
+    // Con needs emplace_back, back and pop_back, like vector, deque or list.
+    template <typename Row, typename Con = std::vector<Row>>
+    class RowConFetcher : public CassFetcher
+    {
+    public:
+
+        virtual ~RowConFetcher() {}
+
+        bool do_fetch(const std::string& query, Con& con)
+        {
+            con.clear();
+            m_conPtr = &con;
+            return CassConn::fetch(query, *this);
+        }
+
+        // if timeout_in_micro == 0, will use global timeout default set in CassConn
+        bool do_fetch(const std::string& query, 
+                      Con& con, 
+                      CassConsistency consist,
+                      cass_duration_t timeout_in_micro = 0)
+        {
+            con.clear();
+            m_conPtr = &con;
+            return CassConn::fetch(query, *this, consist, timeout_in_micro);
+        }
+
+        // fetch with a prepared select, binding Fargs. 
+        // will throw if there is an issue binding values.
+        template<typename... Targs>
+        bool do_fetch(PreparedFetch& prep_fetch, Con& con, const Targs&... Fargs)
+        {
+            con.clear();
+            m_conPtr = &con;
+            return prep_fetch.fetch(*this, Fargs...);
+        }
+
+        // see CassConn::fetch_paged
+        bool do_fetch_paged(const std::string& query, Con& con, unsigned page_size, uint64_t max_rows = 0)
+        {
+            con.clear();
+            m_conPtr = &con;
+            return CassConn::fetch_paged(query, *this, page_size, max_rows);
+        }
+
+    protected:
+
+        virtual bool fetch(const CassRow& result)
+        {
+            m_conPtr->emplace_back();
+            if (RowMapper<Row>::get(m_conPtr->back(), result))
+            {
+                return true;
+            }
+            m_conPtr->pop_back();
+            return false;
+        }
+        Con* m_conPtr;
+    };
+
+    // the same for rows of std::tuple<Ts...>
+    //
+    //     TupleFetcher<cass_int32_t, std::string> fetcher;
+    //     std::tuple<cass_int32_t, std::string> row;
+    //     fetcher.do_fetch("select docid, value from other_test_data where docid=1", row);
+    template <typename... Ts>
+    using TupleFetcher = RowFetcher<std::tuple<Ts...>>;
+
+    template <typename... Ts>
+    using TupleConFetcher = RowConFetcher<std::tuple<Ts...>>;
+}
+
+#endif 
+
@@ -0,0 +1,84 @@
+#ifndef CB_TYPED_PREPARED_STORE_H
+#define CB_TYPED_PREPARED_STORE_H
+
+#include <memory>
+#include "cql-interface/PreparedStore.h"
+
+namespace cb {
+
+    // PreparedStore with the bound types fixed at compile time:
+    //
+    //     auto prep_store = TypedPreparedStore<cass_int32_t, std::string, RefId>::prepare(
+    //                             "insert into t (a, b, c) values(?, ?, ?)");
+    //     prep_store->store(1, value, refid);
+    //
+    // Calling store with the wrong number of values does not compile, values
+    // are converted to Args and passed by reference, and there is no runtime
+    // arity check. Args is also the number of bind markers in the query.
+    template<typename... Args>
+    class TypedPreparedStore
+    {
+    public:
+
+        typedef std::shared_ptr<TypedPreparedStore> Ptr;
+
+        // null if query fails to prepare
+        static Ptr prepare(const std::string& query)
+        {
+            return wrap(CassConn::prepare_store(query, sizeof...(Args)));
+        }
+
+        static Ptr prepare(const std::string& query, 
+                           CassConsistency consist,
+                           cass_duration_t timeout_in_micro = 0)
+        {
+            return wrap(CassConn::prepare_store(query, sizeof...(Args), consist, timeout_in_micro));
+        }
+
+        // will throw if there is an issue binding values
+        bool store(const Args&... args)
+        {
+            return m_prep_store->store_checked(args...);
+        }
+
+        // see PreparedStore::async_store
+        bool async_store(StoreHolderPtr store_holder, const Args&... args)
+        {
+            CassStatement* statement = m_prep_store->new_statement(args...);
+            bool retVal = CassConn::async_store(*m_prep_store, statement, store_holder);
+            cass_statement_free(statement);
+            return retVal;
+        }
+
+        // the untyped store, for BatchBuilder, BulkWriter and set_exec_mode
+        PreparedStore& prep_store()
+        {
+            return *m_prep_store;
+        }
+
+        const std::string& query() const
+        {
+            return m_prep_store->query();
+        }
+
+    private:
+
+        static Ptr wrap(PreparedStorePtr prep_store)
+        {
+            return prep_store ? Ptr(new TypedPreparedStore(prep_store)) : Ptr();
+        }
+
+        explicit TypedPreparedStore(PreparedStorePtr prep_store)
+        : m_prep_store(prep_store)
+        {
+        }
+
+        TypedPreparedStore(const TypedPreparedStore&) = delete;
+        TypedPreparedStore& operator=(const TypedPreparedStore&) = delete;
+
+        PreparedStorePtr m_prep_store;
+    };
+}
+
+#endif 
+
@@ -0,0 +1,87 @@
+#include "log4cxx/logger.h"
+
+#include "cql-interface/WorkerPool.h"
+
+using namespace cb;
+using namespace std;
+
+namespace {
+    log4cxx::LoggerPtr logger(log4cxx::Logger::getLogger("cb.worker_pool"));
+}
+
+WorkerPool::WorkerPool(unsigned num_threads)
+: m_running(0),
+  m_stop(false)
+{
+    if (!num_threads)
+    {
+        num_threads = 1;
+    }
+    m_threads.reserve(num_threads);
+    for (unsigned i = 0; i < num_threads; ++i)
+    {
+        m_threads.push_back(thread(&WorkerPool::run, this));
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        lock_guard<mutex> guard(m_mutex);
+        m_stop = true;
+    }
+    m_task_cond.notify_all();
+    for (auto it = m_threads.begin(); it != m_threads.end(); ++it)
+    {
+        it->join();
+    }
+}
+
+void WorkerPool::post(Task task)
+{
+    // notify under the lock: a task posted from a driver callback can run, and
+    // the pool be waited on and destroyed, before an unlocked notify gets to it
+    lock_guard<mutex> guard(m_mutex);
+    m_tasks.push_back(std::move(task));
+    m_task_cond.notify_one();
+}
+
+void WorkerPool::wait()
+{
+    unique_lock<mutex> lock(m_mutex);
+    m_idle_cond.wait(lock, [this]() { return m_tasks.empty() && !m_running; });
+}
+
+void WorkerPool::run()
+{
+    unique_lock<mutex> lock(m_mutex);
+    while (true)
+    {
+        m_task_cond.wait(lock, [this]() { return m_stop || !m_tasks.empty(); });
+        if (m_tasks.empty())
+        {
+            // m_stop and nothing left to do
+            break;
+        }
+        Task task = std::move(m_tasks.front());
+        m_tasks.pop_front();
+        ++m_running;
+        lock.unlock();
+        try
+        {
+            task();
+        } catch(std::exception& e)
+        {
+            LOG4CXX_ERROR(logger, "Exception in WorkerPool task: " << e.what());
+        } catch(...)
+        {
+            LOG4CXX_ERROR(logger, "unknown exception in WorkerPool task");
+        }
+        lock.lock();
+        --m_running;
+        if (m_tasks.empty() && !m_running)
+        {
+            m_idle_cond.notify_all();
+        }
+    }
+}
@@ -0,0 +1,55 @@
+#ifndef CB_WORKER_POOL_H
+#define CB_WORKER_POOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cb {
+
+    // fixed set of threads running posted tasks in order.
+    // Tasks should not throw; if one does it is logged and dropped.
+    class WorkerPool
+    {
+    public:
+
+        typedef std::function<void()> Task;
+
+        explicit WorkerPool(unsigned num_threads);
+
+        // runs what is already posted, then stops the threads
+        ~WorkerPool();
+
+        void post(Task task);
+
+        // blocks until every posted task has run
+        void wait();
+
+        unsigned size() const
+        {
+            return m_threads.size();
+        }
+
+    private:
+
+        WorkerPool(const WorkerPool&) = delete;
+        WorkerPool& operator=(const WorkerPool&) = delete;
+
+        void run();
+
+        std::mutex m_mutex;
+        std::condition_variable m_task_cond;
+        std::condition_variable m_idle_cond;
+        std::deque<Task> m_tasks;
+        unsigned m_running;
+        bool m_stop;
+
+        std::vector<std::thread> m_threads;
+    };
+}
+
+#endif 
+
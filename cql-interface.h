@@ -6,14 +6,30 @@
 #include "cql-interface/FetchHelper.h"
 #include "cql-interface/Fetcher.h"
 #include "cql-interface/FetcherAsync.h"
+#include "cql-interface/ConInsertTraits.h"
 #include "cql-interface/ConFetcher.h"
+#include "cql-interface/TupleFetcher.h"
+#include "cql-interface/ColumnarFetcher.h"
+#include "cql-interface/ColumnIndex.h"
+#include "cql-interface/FetchArena.h"
 #include "cql-interface/ConFetcherAsync.h"
 #include "cql-interface/CassConn.h"
 #include "cql-interface/RefId.h"
 #include "cql-interface/LogBaseInfo.h"
 #include "cql-interface/Exception.h"
 #include "cql-interface/CassUtil.h"
+#include "cql-interface/PreparedStatement.h"
 #include "cql-interface/PreparedStore.h"
+#include "cql-interface/TypedPreparedStore.h"
+#include "cql-interface/PreparedFetch.h"
+#include "cql-interface/StoreHolder.h"
+#include "cql-interface/BatchBuilder.h"
+#include "cql-interface/Murmur3.h"
+#include "cql-interface/PartitionBatcher.h"
+#include "cql-interface/BulkWriter.h"
+#include "cql-interface/WorkerPool.h"
+#include "cql-interface/TokenRangeScanner.h"
+#include "cql-interface/CoAwait.h"
 
 #endif 
 
@@ -3,6 +3,18 @@
 #include <boost/program_options.hpp>
 #include <boost/test/unit_test.hpp>
 #include <string>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <deque>
+#include <unordered_set>
+#include <unordered_map>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <new>
 #include "log4cxx/logger.h"
 
 using namespace log4cxx;
@@ -15,6 +27,29 @@ using namespace cb;
 extern unsigned nruns;
 extern unsigned nsize;
 extern unsigned npost;
+extern unsigned nbench;
+extern unsigned nthreads;
+extern unsigned ncolumnar;
+
+// counts every heap allocation in the test program, for the allocation benchmarks
+// here and in TestFetchArena.cpp
+std::atomic<uint64_t> num_news(0);
+
+void* operator new(size_t size)
+{
+    num_news.fetch_add(1, std::memory_order_relaxed);
+    void* retVal = malloc(size ? size : 1);
+    if (!retVal)
+    {
+        throw std::bad_alloc();
+    }
+    return retVal;
+}
+
+void operator delete(void* ptr) noexcept
+{
+    free(ptr);
+}
 
 namespace 
 {
@@ -54,6 +89,134 @@ namespace
         TestDocPairs doc_pairs;
     };
 
+    struct OtherDoc
+    {
+        cass_int32_t docid;
+        std::string value;
+    };
+}
+
+namespace cb
+{
+    template<> struct RowMapper<OtherDoc>
+    {
+        static bool get(OtherDoc& obj, const CassRow& row)
+        {
+            return FetchHelper::get_columns(row, obj.docid, obj.value);
+        }
+    };
+}
+
+namespace
+{
+    // hand written version of RowConFetcher<OtherDoc>
+    class OtherDocFetcher : public CassFetcher
+    {
+    public:
+
+        virtual bool fetch(const CassRow& row)
+        {
+            OtherDoc tmp;
+            bool retVal = FetchHelper::get_nth(0, tmp.docid, row) 
+                            && FetchHelper::get_nth(1, tmp.value, row);
+            if (retVal)
+            {
+                docs.push_back(tmp);
+            }
+            return retVal;
+        }
+
+        vector<OtherDoc> docs;
+    };
+
+    // OtherDocFetcher by column name
+    class NamedDocFetcher : public CassFetcher
+    {
+    public:
+
+        NamedDocFetcher()
+        : cols({"docid", "value"})
+        {
+        }
+
+        virtual void begin_result(const CassResult& result)
+        {
+            cols.resolve(result);
+        }
+
+        virtual bool fetch(const CassRow& row)
+        {
+            OtherDoc tmp;
+            bool retVal = cols.get_columns(row, tmp.docid, tmp.value);
+            if (retVal)
+            {
+                docs.push_back(tmp);
+            }
+            return retVal;
+        }
+
+        ColumnIndex cols;
+        vector<OtherDoc> docs;
+    };
+
+    // keeps views of the blob column, or copies when Blob is CassBytesMgr
+    template <typename Blob>
+    class BlobFetcher : public CassFetcher
+    {
+    public:
+
+        virtual bool fetch(const CassRow& row)
+        {
+            blobs.emplace_back();
+            return FetchHelper::get_nth(0, blobs.back(), row);
+        }
+
+        vector<Blob> blobs;
+    };
+
+    // counts rows and sums the first int column, keeps nothing
+    class CountFetcher : public CassFetcher
+    {
+    public:
+
+        CountFetcher()
+        : num_rows(0),
+          sum(0)
+        {
+        }
+
+        virtual bool fetch(const CassRow& row)
+        {
+            int val = 0;
+            bool retVal = FetchHelper::get_nth(0, val, row);
+            if (retVal)
+            {
+                ++num_rows;
+                sum += val;
+            }
+            return retVal;
+        }
+
+        uint64_t num_rows;
+        int64_t sum;
+    };
+
+    // CountFetcher which also does some work per row, like a real decode
+    class SlowCountFetcher : public CountFetcher
+    {
+    public:
+
+        virtual bool fetch(const CassRow& row)
+        {
+            string val;
+            for (unsigned i=0; i<50; ++i)
+            {
+                FetchHelper::get_nth(1, val, row);
+            }
+            return CountFetcher::fetch(row);
+        }
+    };
+
     class TestIfAppliedFetcher : public CassFetcher
     {
     public:
@@ -178,6 +341,37 @@ namespace
     }
 
 
+
+    // runs nbench stores on prep_store split over nthreads (at least 1), returns stores per second
+    double prep_store_throughput(PreparedStorePtr prep_store, int key_base)
+    {
+        std::atomic<unsigned> num_ok(0);
+        const unsigned num_threads = std::max(nthreads, 1u);
+        unsigned per_thread = nbench / num_threads;
+        auto start = std::chrono::steady_clock::now();
+        vector<std::thread> threads;
+        for (unsigned t=0; t<num_threads; ++t)
+        {
+            threads.push_back(std::thread([&, t]()
+            {
+                for (unsigned i=0; i<per_thread; ++i)
+                {
+                    if (prep_store->store(int(key_base + t*per_thread + i), int(i)))
+                    {
+                        ++num_ok;
+                    }
+                }
+            }));
+        }
+        for (auto it = threads.begin(); it != threads.end(); ++it)
+        {
+            it->join();
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        BOOST_REQUIRE_MESSAGE(num_ok == per_thread*num_threads, 
+                              "num_ok[" << num_ok << "] == " << per_thread*num_threads);
+        return elapsed.count() > 0 ? num_ok / elapsed.count() : 0;
+    }
 }
 namespace std
 {
@@ -357,6 +551,60 @@ BOOST_AUTO_TEST_CASE(test_container_list_fetcher)
     test_container<string, list<string> >();
 }
 
+BOOST_AUTO_TEST_CASE(test_container_deque_fetcher) 
+{
+    test_container<string, deque<string> >();
+}
+
+BOOST_AUTO_TEST_CASE(test_container_insert_fetcher) 
+{
+    BOOST_REQUIRE(CassConn::truncate("other_test_data", consist));
+    BOOST_REQUIRE(CassConn::store("insert into other_test_data (docid, value) values(1, 'test data1')"));
+    BOOST_REQUIRE(CassConn::store("insert into other_test_data (docid, value) values(2, 'test data2')"));
+    BOOST_REQUIRE(CassConn::store("insert into other_test_data (docid, value) values(3, 'test data1')"));
+
+    {
+        ConFetcher<string, set<string>> fetcher;
+        set<string> val;
+        BOOST_REQUIRE(fetcher.do_fetch("select value from other_test_data", val));
+        BOOST_REQUIRE(val.size() == 2);
+        BOOST_REQUIRE(val.count("test data1") && val.count("test data2"));
+    }
+    {
+        ConFetcher<cass_int32_t, unordered_set<cass_int32_t>> fetcher;
+        unordered_set<cass_int32_t> val;
+        BOOST_REQUIRE(fetcher.do_fetch("select docid from other_test_data", val));
+        BOOST_REQUIRE(val.size() == 3);
+        BOOST_REQUIRE(val.count(1) && val.count(2) && val.count(3));
+    }
+    {
+        // key and value columns fill a map
+        ConFetcher<pair<cass_int32_t, string>, map<cass_int32_t, string>> fetcher;
+        map<cass_int32_t, string> val;
+        BOOST_REQUIRE(fetcher.do_fetch("select docid, value from other_test_data", val));
+        BOOST_REQUIRE(val.size() == 3);
+        BOOST_REQUIRE(val[2] == "test data2");
+        BOOST_REQUIRE(val[3] == "test data1");
+    }
+    {
+        // or a flat map
+        ConFetcher<pair<cass_int32_t, string>, vector<pair<cass_int32_t, string>>> fetcher;
+        vector<pair<cass_int32_t, string>> val;
+        BOOST_REQUIRE(fetcher.do_fetch("select docid, value from other_test_data", val));
+        BOOST_REQUIRE(val.size() == 3);
+        BOOST_REQUIRE(val.capacity() == 3);     // reserved from the row count
+        std::sort(val.begin(), val.end());
+        BOOST_REQUIRE(val[0].first == 1 && val[0].second == "test data1");
+    }
+    {
+        unordered_map<cass_int32_t, string> val;
+        ConFetcher<pair<cass_int32_t, string>, unordered_map<cass_int32_t, string>> fetcher;
+        BOOST_REQUIRE(fetcher.do_fetch("select docid, value from other_test_data", val));
+        BOOST_REQUIRE(val.size() == 3);
+        BOOST_REQUIRE(!fetcher.do_fetch("select docid from other_test_data", val));
+    }
+}
+
 BOOST_AUTO_TEST_CASE(test_blob) 
 {
     bool ok = CassConn::truncate("blob_data", consist);
@@ -456,6 +704,22 @@ BOOST_AUTO_TEST_CASE(test_fetcher_coll)
         // empty result
         BOOST_REQUIRE(!fetcher.do_fetch("select value_map from coll_test_data where docid=2", val));
     }
+    {
+        // vector<bool> is packed, so decoded apart from other vectors
+        BOOST_REQUIRE(CassConn::store("update coll_test_data set value_bool_list=[true,false,true] where docid=1"));
+        Fetcher<vector<bool>> fetcher;
+        vector<bool> val(5, false);
+        BOOST_REQUIRE(fetcher.do_fetch("select value_bool_list from coll_test_data where docid=1", val));
+        BOOST_REQUIRE(val == vector<bool>({true,false,true}) );
+
+        Fetcher<list<bool>> list_fetcher;
+        list<bool> list_val;
+        BOOST_REQUIRE(list_fetcher.do_fetch("select value_bool_list from coll_test_data where docid=1", list_val));
+        BOOST_REQUIRE(list_val == list<bool>({true,false,true}) );
+
+        // empty result
+        BOOST_REQUIRE(!fetcher.do_fetch("select value_bool_list from coll_test_data where docid=2", val));
+    }
 
 }
 
@@ -482,6 +746,102 @@ BOOST_AUTO_TEST_CASE(test_fetcher_multi_coll)
     }
 }
 
+BOOST_AUTO_TEST_CASE(test_collection_decode_reuse)
+{
+    const unsigned nrows = nbench / 10;
+    const unsigned nloops = 10;
+
+    BOOST_REQUIRE(CassConn::truncate("coll_test_data", consist));
+    PreparedStorePtr coll_store = CassConn::prepare_store(
+            "insert into coll_test_data (docid, value_list, value_map) values(?, ?, ?)", 3);
+    BOOST_REQUIRE(coll_store);
+    {
+        BulkWriter writer(coll_store);
+        for (unsigned docid=0; docid<nrows; ++docid)
+        {
+            // lists of 8 to 15 values, so a reused vector does have to grow some
+            list<int> list_vals;
+            map<int, int> map_vals;
+            for (unsigned i=0; i<8 + docid % 8; ++i)
+            {
+                list_vals.push_back(int(i));
+                map_vals[int(i)] = int(docid);
+            }
+            BOOST_REQUIRE(writer.write(int(docid), list_vals, map_vals));
+        }
+        BOOST_REQUIRE(writer.flush());
+    }
+
+    const string query = "select value_list, value_map from coll_test_data";
+
+    // a new vector per row
+    uint64_t fresh_news = 0;
+    auto start = chrono::steady_clock::now();
+    for (unsigned i=0; i<nloops; ++i)
+    {
+        uint64_t checksum = 0;
+        uint64_t news = num_news.load();
+        BOOST_REQUIRE(CassConn::fetch_each(query, [&](const CassRow& row)
+        {
+            vector<cass_int32_t> value_list;
+            vector<pair<cass_int32_t, cass_int32_t>> value_map;
+            bool retVal = FetchHelper::get_columns(row, value_list, value_map);
+            checksum += value_list.size() + value_map.size();
+            return retVal;
+        }));
+        fresh_news += num_news.load() - news;
+        BOOST_REQUIRE(checksum > 0);
+    }
+    auto fresh_usecs = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count();
+
+    // the same vectors for every row
+    uint64_t reused_news = 0;
+    vector<cass_int32_t> value_list;
+    vector<pair<cass_int32_t, cass_int32_t>> value_map;
+    start = chrono::steady_clock::now();
+    for (unsigned i=0; i<nloops; ++i)
+    {
+        unsigned nfetched = 0;
+        uint64_t news = num_news.load();
+        BOOST_REQUIRE(CassConn::fetch_each(query, [&](const CassRow& row)
+        {
+            bool retVal = FetchHelper::get_columns(row, value_list, value_map);
+            BOOST_REQUIRE(value_list.size() >= 8 && value_list.size() < 16);
+            BOOST_REQUIRE(value_map.size() == value_list.size());
+            BOOST_REQUIRE(value_list.back() == cass_int32_t(value_list.size() - 1));
+            BOOST_REQUIRE(value_map[3].first == 3);
+            ++nfetched;
+            return retVal;
+        }));
+        reused_news += num_news.load() - news;
+        BOOST_REQUIRE(nfetched == nrows);
+    }
+    auto reused_usecs = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count();
+
+    // reused vectors only grow up to the longest collection, not once per row
+    BOOST_REQUIRE(reused_news + 2 * nloops * nrows <= fresh_news);
+
+    BOOST_MESSAGE("decoding list<int> and map<int,int> in " << nloops << " fetches of " << nrows << " rows:"
+                    << " new vectors " << fresh_news << " allocations " << fresh_usecs << " usecs,"
+                    << " reused vectors " << reused_news << " allocations " << reused_usecs << " usecs");
+
+    // a failed decode (int items read as bigint) still frees its iterator,
+    // and leaves only what did decode
+    BOOST_REQUIRE(CassConn::store("insert into coll_test_data (docid, value_list, value_set) "
+                                  "values(-1, [1,2], {3,4})"));
+    set<cass_int32_t> value_set({1, 2, 3});
+    vector<cass_int64_t> bad_list(4, 7);
+    BOOST_REQUIRE(CassConn::fetch_each("select value_list, value_set from coll_test_data where docid=-1",
+                                       [&](const CassRow& row)
+    {
+        BOOST_REQUIRE(!FetchHelper::get_nth(0, bad_list, row));
+        BOOST_REQUIRE(FetchHelper::get_nth(1, value_set, row));
+        return true;
+    }));
+    BOOST_REQUIRE(bad_list.empty());
+    BOOST_REQUIRE(value_set == set<cass_int32_t>({3, 4}));
+}
+
 BOOST_AUTO_TEST_CASE(test_async_fetcher) 
 {
     bool ok = CassConn::truncate("other_test_data", consist);
@@ -686,128 +1046,1315 @@ BOOST_AUTO_TEST_CASE(test_stats_fetched)
 
     BOOST_REQUIRE(CassConn::truncate("other_test_data", consist));
 
+    // only the string differs, so these share two prepared statements
+    Fetcher<string> fetcher;
     for (unsigned i=0; i<nruns; ++i)
     {
         ostringstream cmd;
-        cmd << "insert into other_test_data (docid, value) values(" << i << ", 'test data" << i << "')";
+        cmd << "insert into other_test_data (docid, value) values(1, 'it''s " << i << "')";
         BOOST_REQUIRE(CassConn::store(cmd.str()));
+        string val;
+        BOOST_REQUIRE(fetcher.do_fetch("select value from other_test_data where docid=1", val));
+        ostringstream expected;
+        expected << "it's " << i;
+        BOOST_REQUIRE_MESSAGE(val == expected.str(), "val[" << val << "] == " << expected.str());
     }
-    CassConn::get_stats(stats);     // clear current stats
+    CassConn::get_stats(stats);
+    BOOST_REQUIRE_MESSAGE(stats.m_stmt_cache.m_miss == 2, 
+                          "stats.m_stmt_cache.m_miss[" << stats.m_stmt_cache.m_miss << "] == 2");
+    BOOST_REQUIRE(stats.m_stmt_cache.m_hit == 2*nruns - 2);
+    BOOST_REQUIRE(stats.m_stmt_cache.m_evict == 0);
+
+    // literal types the server does not take fall back to text
+    BOOST_REQUIRE(CassConn::truncate("blob_data", consist));
+    BOOST_REQUIRE(CassConn::store("insert into blob_data (docid, value) values (3, bigintAsBlob(7))"));
+    BOOST_REQUIRE(CassConn::store("insert into blob_data (docid, value) values (3, bigintAsBlob(8))"));
+    Fetcher<int64_t> int_fetcher;
+    int64_t int_val = 0;
+    BOOST_REQUIRE(int_fetcher.do_fetch("select blobAsBigint(value) from blob_data where docid=3", int_val));
+    BOOST_REQUIRE(int_val == 8);
+
+    // numbers go to float and decimal columns as written, the same as with no cache
+    BOOST_REQUIRE(CassConn::truncate("prep_store", consist));
+    const string float_query = "insert into prep_store (int_key, float_value, decimal_value) values(1, 2, 2.5)";
+    BOOST_REQUIRE(CassConn::store(float_query));
+    BOOST_REQUIRE(CassConn::store(float_query));
+    CassConn::set_statement_cache(0);
+    BOOST_REQUIRE(CassConn::store("insert into prep_store (int_key, float_value, decimal_value) values(2, 2, 2.5)"));
+    CassConn::set_statement_cache(2);
+    Fetcher<cass_float_t> float_fetcher;
+    cass_float_t float_val = 0;
+    BOOST_REQUIRE(float_fetcher.do_fetch("select float_value from prep_store where int_key=1", float_val));
+    BOOST_REQUIRE_MESSAGE(float_val == 2, "float_val[" << float_val << "] == 2");
+    Fetcher<CassBytesMgr> bytes_fetcher;
+    CassBytesMgr cached_decimal;
+    CassBytesMgr text_decimal;
+    BOOST_REQUIRE(bytes_fetcher.do_fetch("select decimal_value from prep_store where int_key=1", cached_decimal));
+    BOOST_REQUIRE(bytes_fetcher.do_fetch("select decimal_value from prep_store where int_key=2", text_decimal));
+    BOOST_REQUIRE(cached_decimal.size() > 0);
+    BOOST_REQUIRE(cached_decimal.data() == text_decimal.data());
+
+    // bad queries still fail
+    BOOST_REQUIRE(!CassConn::store("insert into non_table (docid, value) values(1, 'test data1')"));
+    string val;
+    BOOST_REQUIRE(!fetcher.do_fetch("select value from no_table where docid=4", val));
 
-    // good case
+    CassConn::get_stats(stats);
+    BOOST_REQUIRE(stats.m_stmt_cache.m_evict > 0);
+
+    CassConn::set_statement_cache(0);
+}
+
+BOOST_AUTO_TEST_CASE(test_prep_fetch) 
+{
+    BOOST_REQUIRE(CassConn::truncate("other_test_data", consist));
+    BOOST_REQUIRE(CassConn::store("insert into other_test_data (docid, value) values(1, 'test data1')"));
+    BOOST_REQUIRE(CassConn::store("insert into other_test_data (docid, value) values(2, 'test data2')"));
+    BOOST_REQUIRE(CassConn::store("insert into other_test_data (docid, value) values(3, 'test data3')"));
+
+    BOOST_REQUIRE(!CassConn::prepare_fetch("select value from no_table where docid=?", 1));
+
+    PreparedFetchPtr prep_fetch 
+            = CassConn::prepare_fetch("select value from other_test_data where docid=?", 1);
+    BOOST_REQUIRE(prep_fetch);
+    {
+        Fetcher<string> fetcher;
+        string val;
+        BOOST_REQUIRE(fetcher.do_fetch(*prep_fetch, val, 1));
+        BOOST_REQUIRE(val=="test data1");
+        BOOST_REQUIRE(fetcher.do_fetch(*prep_fetch, val, 3));
+        BOOST_REQUIRE(val=="test data3");
+        BOOST_REQUIRE(!fetcher.do_fetch(*prep_fetch, val, 5));
+
+        BOOST_REQUIRE_THROW(fetcher.do_fetch(*prep_fetch, val, 1, 2), Exception);
+    }
+
+    PreparedFetchPtr prep_con_fetch 
+            = CassConn::prepare_fetch("select value from other_test_data where docid in (?, ?)", 2);
+    BOOST_REQUIRE(prep_con_fetch);
+    {
+        ConFetcher<string, vector<string>> fetcher;
+        vector<string> val;
+        BOOST_REQUIRE(fetcher.do_fetch(*prep_con_fetch, val, 2, 3));
+        BOOST_REQUIRE(val.size() == 2);
+        std::sort(val.begin(), val.end());
+        BOOST_REQUIRE(val == vector<string>({"test data2", "test data3"}));
+
+        BOOST_REQUIRE(fetcher.do_fetch(*prep_con_fetch, val, 5, 6));
+        BOOST_REQUIRE(val.size() == 0);
+    }
+
+    // any CassFetcher
+    PreparedFetchPtr prep_all_fetch = CassConn::prepare_fetch("select * from test_data", 0);
+    BOOST_REQUIRE(prep_all_fetch);
+    BOOST_REQUIRE(CassConn::truncate("test_data", consist));
+    RefId auto_refid;
+    BOOST_REQUIRE(CassConn::store("insert into test_data (docid, value) values(AUTO_UUID, 'test data1')", 
+                                  TIMEUUID_ENUM,
+                                  auto_refid,
+                                  consist));
+    TestFetcher test_fetcher;
+    BOOST_REQUIRE(prep_all_fetch->fetch(test_fetcher));
+    BOOST_REQUIRE(test_fetcher.doc_pairs.size() == 1);
+    BOOST_REQUIRE(test_fetcher.doc_pairs.front().docid == auto_refid);
+    BOOST_REQUIRE(test_fetcher.doc_pairs.front().value == "test data1");
+}
+
+BOOST_AUTO_TEST_CASE(test_async_store) 
+{
+    BOOST_REQUIRE(CassConn::truncate("other_test_data", consist));
+
+    // several stores in flight at once
+    vector<StoreHolderPtr> holders;
+    for (int i=0; i<5; ++i)
+    {
+        ostringstream query;
+        query << "insert into other_test_data (docid, value) values(" << i << ", 'async data" << i << "')";
+        StoreHolderPtr holder(new StoreHolder());
+        BOOST_REQUIRE(CassConn::async_store(query.str(), holder));
+        holders.push_back(holder);
+    }
+    for (auto it = holders.begin(); it != holders.end(); ++it)
+    {
+        BOOST_REQUIRE((*it)->wait());
+        BOOST_REQUIRE((*it)->is_ready());
+        BOOST_REQUIRE((*it)->wait());   // same answer the second time
+    }
     Fetcher<string> fetcher;
     string val;
-    for (unsigned i=0; i<nruns; ++i)
+    BOOST_REQUIRE(fetcher.do_fetch("select value from other_test_data where docid=4", val));
+    BOOST_REQUIRE(val=="async data4");
+
+    // bad query
+    StoreHolderPtr bad_holder(new StoreHolder());
+    BOOST_REQUIRE(CassConn::async_store("insert into no_table (docid, value) values(1, 'x')", bad_holder));
+    BOOST_REQUIRE(!bad_holder->wait());
+
+    // callback, on a prepared store
+    PreparedStorePtr prep_store 
+            = CassConn::prepare_store("insert into other_test_data (docid, value) values(?, ?)", 2);
+    BOOST_REQUIRE(prep_store);
+    std::mutex mutex;
+    std::condition_variable done_cond;
+    unsigned num_done = 0;
+    unsigned num_ok = 0;
+    vector<StoreHolderPtr> prep_holders;
+    for (int i=10; i<15; ++i)
     {
-        BOOST_REQUIRE(fetcher.do_fetch("select value from other_test_data where docid in (1)", val));
-        BOOST_REQUIRE(val=="test data1");
+        StoreHolderPtr holder(new StoreHolder());
+        BOOST_REQUIRE(prep_store->async_store(holder, i, string("prep async data")));
+        BOOST_REQUIRE(holder->on_complete([&](bool ok)
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            ++num_done;
+            num_ok += ok;
+            done_cond.notify_all();
+        }));
+        prep_holders.push_back(holder);
     }
-    CassConn::get_stats(stats);     // clear current stats
-    BOOST_REQUIRE_MESSAGE(stats.m_fetched.m_call == nruns,
-                          "stats.m_fetched.m_call[" << stats.m_fetched.m_call
-                          << "] == nruns[" << nruns << "]");
-    BOOST_REQUIRE(stats.m_fetched.m_timeout == 0);
-    BOOST_REQUIRE(stats.m_fetched.m_bad == 0);
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        BOOST_REQUIRE(done_cond.wait_for(lock, std::chrono::seconds(10), [&]() { return num_done == 5; }));
+        BOOST_REQUIRE(num_ok == 5);
+    }
+    BOOST_REQUIRE(fetcher.do_fetch("select value from other_test_data where docid=12", val));
+    BOOST_REQUIRE(val=="prep async data");
 
-    // bad case
-    for (unsigned i=0; i<3; ++i)
+    // callback after the store is done is called right away
+    bool was_called = false;
+    BOOST_REQUIRE(prep_holders.front()->on_complete([&](bool ok) { was_called = ok; }));
+    BOOST_REQUIRE(was_called);
+}
+
+BOOST_AUTO_TEST_CASE(test_batch) 
+{
+    BOOST_REQUIRE(CassConn::truncate("other_test_data", consist));
+
+    PreparedStorePtr prep_store 
+            = CassConn::prepare_store("insert into other_test_data (docid, value) values(?, ?)", 2);
+    BOOST_REQUIRE(prep_store);
+
+    CassConn::FullStats stats;
+    CassConn::get_stats(stats);
+
+    BatchBuilder batch;
+    BOOST_REQUIRE(batch.empty());
+    BOOST_REQUIRE(batch.execute());         // nothing to do
+    StoreHolderPtr empty_holder(new StoreHolder());
+    BOOST_REQUIRE(batch.async_execute(empty_holder));
+    BOOST_REQUIRE(empty_holder->is_ready());
+    BOOST_REQUIRE(empty_holder->wait());
+    BOOST_REQUIRE(batch.add("insert into other_test_data (docid, value) values(1, 'batch data1')"));
+    BOOST_REQUIRE(batch.add(*prep_store, 2, string("batch data2")));
+    BOOST_REQUIRE(batch.add(*prep_store, 3, string("batch data3")));
+    BOOST_REQUIRE_THROW(batch.add(*prep_store, 4), Exception);
+    BOOST_REQUIRE(batch.size() == 3);
+    BOOST_REQUIRE(batch.execute());
+    BOOST_REQUIRE(batch.empty());
+
+    CassConn::get_stats(stats);
+    BOOST_REQUIRE_MESSAGE(stats.m_stored.m_call == 1, "stats.m_stored.m_call: " << stats.m_stored.m_call);
+
+    ConFetcher<string, vector<string>> fetcher;
+    vector<string> vals;
+    BOOST_REQUIRE(fetcher.do_fetch("select value from other_test_data where docid in (1,2,3)", vals));
+    std::sort(vals.begin(), vals.end());
+    BOOST_REQUIRE(vals == vector<string>({"batch data1", "batch data2", "batch data3"}));
+
+    // max bytes
+    BatchBuilder small_batch(BATCH_UNLOGGED_ENUM, 200);
+    string big_value(150, 'x');
+    BOOST_REQUIRE(small_batch.add(*prep_store, 10, big_value));     // first always goes in
+    BOOST_REQUIRE(!small_batch.add(*prep_store, 11, big_value));
+    BOOST_REQUIRE(small_batch.size() == 1);
+    BOOST_REQUIRE(small_batch.num_bytes() <= small_batch.max_bytes());
+
+    StoreHolderPtr holder(new StoreHolder());
+    BOOST_REQUIRE(small_batch.async_execute(holder));
+    BOOST_REQUIRE(small_batch.empty());
+    BOOST_REQUIRE(holder->wait());
+    BOOST_REQUIRE(small_batch.add(*prep_store, 11, big_value));
+    BOOST_REQUIRE(small_batch.execute());
+
+    // bad statement fails the whole batch
+    BOOST_REQUIRE(batch.add(*prep_store, 20, string("batch data20")));
+    BOOST_REQUIRE(batch.add("insert into no_table (docid, value) values(21, 'x')"));
+    BOOST_REQUIRE(!batch.execute());
+    CassConn::get_stats(stats);
+    BOOST_REQUIRE(stats.m_stored.m_bad == 1);
+
+    // counters
+    BOOST_REQUIRE(CassConn::truncate("counter_data", consist));
+    PreparedStorePtr prep_counter 
+            = CassConn::prepare_store("update counter_data set hits = hits + ? where docid = ?", 2);
+    BOOST_REQUIRE(prep_counter);
+    BatchBuilder counter_batch(BATCH_COUNTER_ENUM, BatchBuilder::def_max_bytes, consist);
+    BOOST_REQUIRE(counter_batch.add(*prep_counter, cass_int64_t(2), 1));
+    BOOST_REQUIRE(counter_batch.add(*prep_counter, cass_int64_t(3), 1));
+    BOOST_REQUIRE(counter_batch.add("update counter_data set hits = hits + 1 where docid = 2"));
+    BOOST_REQUIRE(counter_batch.execute());
+
+    Fetcher<cass_int64_t> counter_fetcher;
+    cass_int64_t hits = 0;
+    BOOST_REQUIRE(counter_fetcher.do_fetch("select hits from counter_data where docid = 1", hits));
+    BOOST_REQUIRE(hits == 5);
+}
+
+BOOST_AUTO_TEST_CASE(test_partition_batch) 
+{
+    BOOST_REQUIRE(CassConn::truncate("partition_data", consist));
+
+    PreparedStorePtr prep_store 
+            = CassConn::prepare_store("insert into partition_data (part_key, item, value) values(?, ?, ?)", 3);
+    BOOST_REQUIRE(prep_store);
+
+    PartitionBatcher batcher;
+    for (int item=0; item<10; ++item)
     {
-        BOOST_REQUIRE(!fetcher.do_fetch("select value from non_table where docid in (1)", val));
+        for (int part_key=0; part_key<3; ++part_key)
+        {
+            BOOST_REQUIRE(batcher.add(PartitionKey::make(part_key), *prep_store, 
+                                      part_key, item, string("partition data")));
+        }
     }
-    CassConn::get_stats(stats);     // clear current stats
-    BOOST_REQUIRE(stats.m_fetched.m_call == 0);
-    BOOST_REQUIRE(stats.m_fetched.m_timeout == 0);
-    BOOST_REQUIRE(stats.m_fetched.m_bad == 3);
+    BOOST_REQUIRE(batcher.size() == 30);
+    BOOST_REQUIRE(batcher.num_partitions() == 3);
+    BOOST_REQUIRE(batcher.num_batches() == 3);
+    BOOST_REQUIRE(batcher.execute());
+    BOOST_REQUIRE(batcher.size() == 0);
+
+    ConFetcher<int, vector<int>> fetcher;
+    vector<int> items;
+    BOOST_REQUIRE(fetcher.do_fetch("select item from partition_data where part_key=1", items));
+    BOOST_REQUIRE(items.size() == 10);
+
+    // client side token is the same as the server token
+    Fetcher<cass_int64_t> token_fetcher;
+    cass_int64_t token = 0;
+    BOOST_REQUIRE(token_fetcher.do_fetch("select token(part_key) from partition_data where part_key=2 limit 1", 
+                                         token));
+    BOOST_REQUIRE_MESSAGE(token == PartitionKey::token(2), token << " == " << PartitionKey::token(2));
+
+    // more batches than the driver queue holds are sent a window at a time
+    BOOST_REQUIRE(CassConn::truncate("partition_data", consist));
+    const int num_parts = int(CassConn::get_queue_size_io()) + 10;
+    for (int part_key=0; part_key<num_parts; ++part_key)
+    {
+        BOOST_REQUIRE(batcher.add(PartitionKey::make(part_key), *prep_store, 
+                                  part_key, 1, string("partition data")));
+    }
+    BOOST_REQUIRE(batcher.num_batches() == size_t(num_parts));
+    BOOST_REQUIRE(batcher.execute());
+    Fetcher<cass_int64_t> count_fetcher;
+    cass_int64_t count = 0;
+    BOOST_REQUIRE(count_fetcher.do_fetch("select count(*) from partition_data", count));
+    BOOST_REQUIRE_MESSAGE(count == num_parts, "count[" << count << "] == " << num_parts);
+}
 
-    // timeout case
-    for (unsigned i=0; i<nruns; ++i)
+BOOST_AUTO_TEST_CASE(test_partition_batch_bench) 
+{
+    // nbench rows spread over 100 partitions, written in batches of 50 statements
+    const int num_parts = 100;
+    const unsigned batch_size = 50;
+    PreparedStorePtr prep_store 
+            = CassConn::prepare_store("insert into partition_data (part_key, item, value) values(?, ?, ?)", 3);
+    BOOST_REQUIRE(prep_store);
+
+    // naive: batches in arrival order, each one spans many partitions
+    BOOST_REQUIRE(CassConn::truncate("partition_data", consist));
+    auto start = std::chrono::steady_clock::now();
+    {
+        vector<std::unique_ptr<BatchBuilder>> batches;
+        for (unsigned i=0; i<nbench; ++i)
+        {
+            if (batches.empty() || batches.back()->size() == batch_size)
+            {
+                batches.push_back(std::unique_ptr<BatchBuilder>(new BatchBuilder(BATCH_UNLOGGED_ENUM)));
+            }
+            batches.back()->add(*prep_store, int(i % num_parts), int(i), string("partition data"));
+        }
+        vector<StoreHolderPtr> holders;
+        for (auto it = batches.begin(); it != batches.end(); ++it)
+        {
+            holders.push_back(StoreHolderPtr(new StoreHolder()));
+            BOOST_REQUIRE((*it)->async_execute(holders.back()));
+        }
+        for (auto it = holders.begin(); it != holders.end(); ++it)
+        {
+            BOOST_REQUIRE((*it)->wait());
+        }
+    }
+    std::chrono::duration<double> naive = std::chrono::steady_clock::now() - start;
+
+    // grouped: one batch per partition
+    BOOST_REQUIRE(CassConn::truncate("partition_data", consist));
+    start = std::chrono::steady_clock::now();
     {
-        BOOST_REQUIRE(!fetcher.do_fetch("select value from other_test_data where docid in (1)", 
-                                        val,
-                                        CASS_CONSISTENCY_LOCAL_QUORUM, 
-                                        1));  // 1 microsec
+        PartitionBatcher batcher;
+        for (unsigned i=0; i<nbench; ++i)
+        {
+            int part_key = i % num_parts;
+            batcher.add(PartitionKey::make(part_key), *prep_store, part_key, int(i), string("partition data"));
+        }
+        BOOST_REQUIRE(batcher.execute());
     }
-    CassConn::get_stats(stats);     // clear current stats
-    BOOST_REQUIRE(stats.m_fetched.m_call == 0);
-    BOOST_REQUIRE(stats.m_fetched.m_timeout == nruns);
-    BOOST_REQUIRE(stats.m_fetched.m_bad == 0);
-    BOOST_MESSAGE("did see " << stats.m_fetched.m_timeout << " timeouts");
+    std::chrono::duration<double> grouped = std::chrono::steady_clock::now() - start;
+
+    BOOST_MESSAGE("unlogged batches for " << nbench << " rows over " << num_parts << " partitions:"
+                    << " naive " << (naive.count() > 0 ? nbench / naive.count() : 0) << " rows/sec"
+                    << " partition grouped " << (grouped.count() > 0 ? nbench / grouped.count() : 0) 
+                    << " rows/sec");
+}
+
+BOOST_AUTO_TEST_CASE(test_bulk_writer) 
+{
+    BOOST_REQUIRE(CassConn::truncate("prep_store", consist));
+
+    PreparedStorePtr prep_store 
+            = CassConn::prepare_store("insert into prep_store (int_key, int_value) values(?, ?)", 2);
+    BOOST_REQUIRE(prep_store);
+
+    // one at a time, for comparison
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned i=0; i<nbench; ++i)
+    {
+        BOOST_REQUIRE(prep_store->store(int(i), int(i)));
+    }
+    std::chrono::duration<double> sync = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    BulkWriter writer(prep_store);
+    BOOST_REQUIRE(writer.window() > 0);
+    BOOST_REQUIRE(writer.window() <= CassConn::get_queue_size_io());
+    BOOST_REQUIRE_THROW(writer.write(1), Exception);
+    for (unsigned i=0; i<nbench; ++i)
+    {
+        BOOST_REQUIRE(writer.write(int(nbench + i), int(i)));
+        BOOST_REQUIRE(writer.in_flight() <= writer.window());
+    }
+    BOOST_REQUIRE(writer.flush());
+    std::chrono::duration<double> bulk = std::chrono::steady_clock::now() - start;
+    BOOST_REQUIRE(writer.in_flight() == 0);
+    BOOST_REQUIRE(writer.summary().m_written == nbench);
+    BOOST_REQUIRE(writer.summary().m_failed == 0);
+
+    Fetcher<cass_int64_t> fetcher;
+    cass_int64_t count = 0;
+    BOOST_REQUIRE(fetcher.do_fetch("select count(*) from prep_store", count));
+    BOOST_REQUIRE_MESSAGE(count == 2*nbench, "count[" << count << "] == " << 2*nbench);
+
+    BOOST_MESSAGE("storing " << nbench << " rows: one at a time " 
+                    << (sync.count() > 0 ? nbench / sync.count() : 0) << " rows/sec"
+                    << " BulkWriter with window " << writer.window() << " "
+                    << (bulk.count() > 0 ? nbench / bulk.count() : 0) << " rows/sec");
+}
+
+BOOST_AUTO_TEST_CASE(test_typed_prep_store) 
+{
+    BOOST_REQUIRE(CassConn::truncate("prep_store", consist));
+
+    BOOST_REQUIRE(!(TypedPreparedStore<cass_int32_t>::prepare("insert into no_table (int_key) values(?)")));
+
+    typedef TypedPreparedStore<cass_int32_t, std::string, cass_int64_t, std::vector<int>> TypedStore;
+    TypedStore::Ptr prep_store = TypedStore::prepare(
+            "insert into prep_store (int_key, text_value, bigint_value, list_value) values(?, ?, ?, ?)",
+            consist);
+    BOOST_REQUIRE(prep_store);
+
+    // prep_store->store(1, string("x")) would not compile
+    vector<int> list_value({1,2,3});
+    BOOST_REQUIRE(prep_store->store(1, "typed text", 1233424332344, list_value));
+    BOOST_REQUIRE(prep_store->store(2, string("typed text2"), 3, vector<int>()));
+
+    StoreHolderPtr holder(new StoreHolder());
+    BOOST_REQUIRE(prep_store->async_store(holder, 3, "typed text3", 4, list_value));
+    BOOST_REQUIRE(holder->wait());
+
+    // the untyped store still works with the rest of the library
+    BatchBuilder batch;
+    BOOST_REQUIRE(batch.add(prep_store->prep_store(), 4, string("typed text4"), cass_int64_t(5), list_value));
+    BOOST_REQUIRE(batch.execute());
+
+    Fetcher<string> fetcher;
+    string val;
+    BOOST_REQUIRE(fetcher.do_fetch("select text_value from prep_store where int_key = 1", val));
+    BOOST_REQUIRE(val == "typed text");
+    BOOST_REQUIRE(fetcher.do_fetch("select text_value from prep_store where int_key = 4", val));
+    BOOST_REQUIRE(val == "typed text4");
+
+    Fetcher<cass_int64_t> int64_fetcher;
+    cass_int64_t int64_val = 0;
+    BOOST_REQUIRE(int64_fetcher.do_fetch("select bigint_value from prep_store where int_key = 1", int64_val));
+    BOOST_REQUIRE(int64_val == 1233424332344);
+    BOOST_REQUIRE(int64_fetcher.do_fetch("select bigint_value from prep_store where int_key = 3", int64_val));
+    BOOST_REQUIRE(int64_val == 4);
+}
+
+BOOST_AUTO_TEST_CASE(test_prep_store_ranges) 
+{
+    BOOST_REQUIRE(CassConn::truncate("prep_store", consist));
+
+    PreparedStorePtr prep_store = CassConn::prepare_store(
+            "insert into prep_store (int_key, list_value, set_value, map_value) values(?, ?, ?, ?)", 4);
+    BOOST_REQUIRE(prep_store);
+
+    int ints[] = {5, 3, 1, 3};
+    vector<pair<int,int>> pairs = { {1,2}, {2,4}, {4,8} };
+    BOOST_REQUIRE(prep_store->store(1, as_list(ints, 4), as_set(ints, 4), as_map(pairs.begin(), pairs.end())));
+
+    std::deque<int> deque_val = {7, 8};
+    std::unordered_set<int> uset_val = {9, 10};
+    std::unordered_map<int,int> umap_val = { {3, 6} };
+    BOOST_REQUIRE(prep_store->store(2, deque_val, uset_val, umap_val));
+
+    Fetcher<vector<int>> list_fetcher;
+    vector<int> list_val;
+    BOOST_REQUIRE(list_fetcher.do_fetch("select list_value from prep_store where int_key = 1", list_val));
+    BOOST_REQUIRE(list_val == vector<int>({5, 3, 1, 3}));
+    BOOST_REQUIRE(list_fetcher.do_fetch("select list_value from prep_store where int_key = 2", list_val));
+    BOOST_REQUIRE(list_val == vector<int>({7, 8}));
+
+    Fetcher<set<int>> set_fetcher;
+    set<int> set_val;
+    BOOST_REQUIRE(set_fetcher.do_fetch("select set_value from prep_store where int_key = 1", set_val));
+    BOOST_REQUIRE(set_val == set<int>({1, 3, 5}));
+    BOOST_REQUIRE(set_fetcher.do_fetch("select set_value from prep_store where int_key = 2", set_val));
+    BOOST_REQUIRE(set_val == set<int>({9, 10}));
+
+    Fetcher<map<int,int>> map_fetcher;
+    map<int,int> map_val;
+    BOOST_REQUIRE(map_fetcher.do_fetch("select map_value from prep_store where int_key = 1", map_val));
+    BOOST_REQUIRE((map_val == map<int,int>({ {1,2}, {2,4}, {4,8} })));
+    BOOST_REQUIRE(map_fetcher.do_fetch("select map_value from prep_store where int_key = 2", map_val));
+    BOOST_REQUIRE((map_val == map<int,int>({ {3,6} })));
+}
+
+BOOST_AUTO_TEST_CASE(test_prep_store_views) 
+{
+    BOOST_REQUIRE(CassConn::truncate("prep_store", consist));
+
+    PreparedStorePtr prep_store = CassConn::prepare_store(
+            "insert into prep_store (int_key, text_value, blob_value) values(?, ?, ?)", 3);
+    BOOST_REQUIRE(prep_store);
+
+    string big(300 * 1024, 'x');
+    BOOST_REQUIRE(prep_store->store(1, "literal text", as_bytes(big)));
+    BOOST_REQUIRE(prep_store->store(2, as_text(big.data(), 4), as_bytes(big.data(), 2)));
+    const char* null_text = 0;
+    BOOST_REQUIRE(prep_store->store(3, null_text, NullBinder()));
+
+    // buffer is moved in, not copied
+    CassBytesMgr::Bytes buffer(1000, 7);
+    const cass_byte_t* buffer_data = &buffer.front();
+    CassBytesMgr bytes_mgr(std::move(buffer));
+    BOOST_REQUIRE(bytes_mgr.view().data == buffer_data);
+    BOOST_REQUIRE(bytes_mgr.view().size == 1000);
+    BOOST_REQUIRE(prep_store->store(4, string("bytes mgr"), bytes_mgr));
+    CassBytesMgr moved(std::move(bytes_mgr));
+    BOOST_REQUIRE(moved.view().data == buffer_data);
+    BOOST_REQUIRE(moved.release().size() == 1000);
+    BOOST_REQUIRE(moved.size() == 0);
+
+    Fetcher<string> fetcher;
+    string val;
+    BOOST_REQUIRE(fetcher.do_fetch("select text_value from prep_store where int_key = 1", val));
+    BOOST_REQUIRE(val == "literal text");
+    BOOST_REQUIRE(fetcher.do_fetch("select text_value from prep_store where int_key = 2", val));
+    BOOST_REQUIRE(val == "xxxx");
+
+    Fetcher<CassBytesMgr> bytes_fetcher;
+    CassBytesMgr bytes_val;
+    BOOST_REQUIRE(bytes_fetcher.do_fetch("select blob_value from prep_store where int_key = 1", bytes_val));
+    BOOST_REQUIRE(bytes_val.size() == big.size());
+    BOOST_REQUIRE(bytes_fetcher.do_fetch("select blob_value from prep_store where int_key = 4", bytes_val));
+    BOOST_REQUIRE(bytes_val.size() == 1000);
 }
 
-BOOST_AUTO_TEST_CASE(test_prep_store) 
+BOOST_AUTO_TEST_CASE(test_fetch_paged) 
 {
-    bool ok = CassConn::truncate("prep_store", consist);
-    BOOST_REQUIRE_MESSAGE(ok, "cleared prep_store table");
+    BOOST_REQUIRE(CassConn::truncate("partition_data", consist));
 
+    PreparedStorePtr prep_store 
+            = CassConn::prepare_store("insert into partition_data (part_key, item, value) values(?, ?, ?)", 3);
+    BOOST_REQUIRE(prep_store);
+    BulkWriter writer(prep_store);
+    for (int item=0; item<250; ++item)
     {
-        string val = "hi there";
-        test_prep_store_call(val, "ascii_value");
+        BOOST_REQUIRE(writer.write(item % 2, item, string("paged data")));
     }
+    BOOST_REQUIRE(writer.flush());
+
+    CassConn::FullStats stats;
+    CassConn::get_stats(stats);
     {
-        string val = "hi there";
-        test_prep_store_call(val, "text_value");
+        CountFetcher fetcher;
+        BOOST_REQUIRE(CassConn::fetch_paged("select item from partition_data", fetcher, 100));
+        BOOST_REQUIRE_MESSAGE(fetcher.num_rows == 250, "fetcher.num_rows: " << fetcher.num_rows);
+        BOOST_REQUIRE(fetcher.sum == 249*250/2);
+        CassConn::get_stats(stats);
+        BOOST_REQUIRE(stats.m_fetched.m_call == 1);
+        BOOST_REQUIRE(stats.m_paged.m_rows == 250);
+        BOOST_REQUIRE_MESSAGE(stats.m_paged.m_pages >= 3, "stats.m_paged.m_pages: " << stats.m_paged.m_pages);
     }
     {
-        cass_int64_t val = 1233424332344;
-        test_prep_store_call(val, "bigint_value");
+        CountFetcher fetcher;
+        BOOST_REQUIRE(CassConn::fetch_paged("select item from partition_data", fetcher, 100, 120));
+        BOOST_REQUIRE(fetcher.num_rows == 120);
+        CassConn::get_stats(stats);
+        BOOST_REQUIRE(stats.m_paged.m_rows == 120);
+        BOOST_REQUIRE(stats.m_paged.m_pages == 2);
     }
     {
-        CassBytesMgr val;
-        for (uint8_t i=0; i<128; ++i)
+        CountFetcher fetcher;
+        BOOST_REQUIRE(!CassConn::fetch_paged("select item from no_table", fetcher, 100));
+        BOOST_REQUIRE(!CassConn::fetch_paged("select item from partition_data", fetcher, 0));
+    }
+
+    PreparedFetchPtr prep_fetch 
+            = CassConn::prepare_fetch("select item from partition_data where part_key=?", 1);
+    BOOST_REQUIRE(prep_fetch);
+    {
+        CountFetcher fetcher;
+        BOOST_REQUIRE(prep_fetch->fetch_paged(fetcher, 10, 0, 1));
+        BOOST_REQUIRE(fetcher.num_rows == 125);
+        BOOST_REQUIRE(fetcher.sum == 125*125);      // odd items 1..249
+        CassConn::get_stats(stats);
+        BOOST_REQUIRE(stats.m_paged.m_pages >= 13);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_fetch_paged_prefetch) 
+{
+    BOOST_REQUIRE(CassConn::truncate("partition_data", consist));
+
+    PreparedStorePtr prep_store 
+            = CassConn::prepare_store("insert into partition_data (part_key, item, value) values(?, ?, ?)", 3);
+    BOOST_REQUIRE(prep_store);
+    {
+        BulkWriter writer(prep_store);
+        for (unsigned item=0; item<nbench; ++item)
+        {
+            BOOST_REQUIRE(writer.write(int(item % 10), int(item), string("paged data")));
+        }
+        BOOST_REQUIRE(writer.flush());
+    }
+
+    CassConn::FullStats stats;
+    CassConn::get_stats(stats);
+
+    CassConn::set_page_mode(CassConn::PAGE_SEQUENTIAL_ENUM);
+    auto start = std::chrono::steady_clock::now();
+    SlowCountFetcher seq_fetcher;
+    BOOST_REQUIRE(CassConn::fetch_paged("select item, value from partition_data", seq_fetcher, 500));
+    std::chrono::duration<double> seq_elapsed = std::chrono::steady_clock::now() - start;
+    BOOST_REQUIRE(seq_fetcher.num_rows == nbench);
+    CassConn::get_stats(stats);
+    CassConn::PageStats seq_stats = stats.m_paged;
+
+    CassConn::set_page_mode(CassConn::PAGE_PREFETCH_ENUM);
+    start = std::chrono::steady_clock::now();
+    SlowCountFetcher prefetch_fetcher;
+    BOOST_REQUIRE(CassConn::fetch_paged("select item, value from partition_data", prefetch_fetcher, 500));
+    std::chrono::duration<double> prefetch_elapsed = std::chrono::steady_clock::now() - start;
+    BOOST_REQUIRE(prefetch_fetcher.num_rows == nbench);
+    BOOST_REQUIRE(prefetch_fetcher.sum == seq_fetcher.sum);
+    CassConn::get_stats(stats);
+    CassConn::PageStats prefetch_stats = stats.m_paged;
+    BOOST_REQUIRE(prefetch_stats.m_pages == seq_stats.m_pages);
+
+    // max_rows still holds when the next page is already on the way
+    CountFetcher max_fetcher;
+    BOOST_REQUIRE(CassConn::fetch_paged("select item from partition_data", max_fetcher, 100, 250));
+    BOOST_REQUIRE(max_fetcher.num_rows == 250);
+
+    BOOST_MESSAGE("fetch_paged of " << nbench << " rows in " << seq_stats.m_pages << " pages:"
+                    << " sequential " << seq_elapsed.count() << " sec, " 
+                    << seq_stats.m_wait_micro / seq_stats.m_pages << " micro wait/page;"
+                    << " prefetch " << prefetch_elapsed.count() << " sec, " 
+                    << prefetch_stats.m_wait_micro / prefetch_stats.m_pages << " micro wait/page");
+}
+
+BOOST_AUTO_TEST_CASE(test_token_range_scan) 
+{
+    BOOST_REQUIRE(CassConn::truncate("partition_data", consist));
+
+    PreparedStorePtr prep_store 
+            = CassConn::prepare_store("insert into partition_data (part_key, item, value) values(?, ?, ?)", 3);
+    BOOST_REQUIRE(prep_store);
+    int64_t expected_sum = 0;
+    {
+        BulkWriter writer(prep_store);
+        for (unsigned item=0; item<nbench; ++item)
+        {
+            BOOST_REQUIRE(writer.write(int(item % 100), int(item), string("scan data")));
+            expected_sum += item;
+        }
+        BOOST_REQUIRE(writer.flush());
+    }
+
+    TokenRangeScanner scanner("partition_data", "part_key", "item, value");
+    scanner.set_page_size(500);
+
+    std::chrono::duration<double> one_worker;
+    for (unsigned num_workers = 1; num_workers <= nthreads; num_workers *= 2)
+    {
+        scanner.set_num_workers(num_workers);
+        scanner.set_num_ranges(4 * nthreads);
+
+        uint64_t num_rows = 0;
+        int64_t sum = 0;
+        std::vector<unsigned> seen(num_workers, 0);
+        auto start = std::chrono::steady_clock::now();
+        bool ok = scanner.scan([](unsigned)
+                               {
+                                   return CassFetcherPtr(new SlowCountFetcher());
+                               },
+                               [&](unsigned worker, CassFetcher& fetcher)
+                               {
+                                   CountFetcher& count_fetcher = static_cast<CountFetcher&>(fetcher);
+                                   num_rows += count_fetcher.num_rows;
+                                   sum += count_fetcher.sum;
+                                   ++seen[worker];
+                               });
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        BOOST_REQUIRE(ok);
+        BOOST_REQUIRE(scanner.summary().m_ranges == 4 * nthreads);
+        BOOST_REQUIRE(scanner.summary().m_failed == 0);
+        BOOST_REQUIRE_MESSAGE(num_rows == nbench, "num_rows[" << num_rows << "] == " << nbench);
+        BOOST_REQUIRE(sum == expected_sum);
+        BOOST_REQUIRE(std::count(seen.begin(), seen.end(), 1u) == int(num_workers));
+
+        if (num_workers == 1)
+        {
+            one_worker = elapsed;
+        }
+        BOOST_MESSAGE("token range scan of " << nbench << " rows with " << num_workers << " workers " 
+                        << elapsed.count() << " sec, speedup " 
+                        << (elapsed.count() > 0 ? one_worker.count() / elapsed.count() : 0));
+    }
+
+    TokenRangeScanner bad_scanner("no_table", "part_key");
+    BOOST_REQUIRE(!bad_scanner.scan([](unsigned) { return CassFetcherPtr(new CountFetcher()); }));
+
+    // a throwing factory fails the scan instead of only being logged
+    scanner.set_num_workers(2);
+    BOOST_REQUIRE(!scanner.scan([](unsigned worker) -> CassFetcherPtr
+                                {
+                                    if (worker == 1)
+                                    {
+                                        throw Exception("bad factory", __FILE__, __LINE__);
+                                    }
+                                    return CassFetcherPtr(new CountFetcher());
+                                }));
+    BOOST_REQUIRE(scanner.summary().m_failed == 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_multi_get) 
+{
+    BOOST_REQUIRE(CassConn::truncate("other_test_data", consist));
+    PreparedStorePtr prep_store 
+            = CassConn::prepare_store("insert into other_test_data (docid, value) values(?, ?)", 2);
+    BOOST_REQUIRE(prep_store);
+    {
+        BulkWriter writer(prep_store);
+        for (int docid=0; docid<1000; ++docid)
+        {
+            ostringstream value;
+            value << "test data" << docid;
+            BOOST_REQUIRE(writer.write(docid, value.str()));
+        }
+        BOOST_REQUIRE(writer.flush());
+    }
+
+    PreparedFetchPtr prep_fetch 
+            = CassConn::prepare_fetch("select value from other_test_data where docid=?", 1);
+    BOOST_REQUIRE(prep_fetch);
+
+    ConFetcher<string, vector<string>> fetcher;
+    vector<string> val;
+    vector<bool> key_ok;
+    {
+        // rows come back in key order, missing keys just add nothing
+        vector<int> keys = {5, 2, 5000, 7};
+        BOOST_REQUIRE(fetcher.multi_get(*prep_fetch, val, keys, key_ok, 2));
+        BOOST_REQUIRE(key_ok.size() == 4);
+        BOOST_REQUIRE(std::count(key_ok.begin(), key_ok.end(), true) == 4);
+        BOOST_REQUIRE(val.size() == 3);
+        BOOST_REQUIRE(val[0] == "test data5");
+        BOOST_REQUIRE(val[1] == "test data2");
+        BOOST_REQUIRE(val[2] == "test data7");
+    }
+    {
+        vector<int> keys;
+        BOOST_REQUIRE(fetcher.multi_get(*prep_fetch, val, keys, key_ok));
+        BOOST_REQUIRE(val.empty());
+        BOOST_REQUIRE(key_ok.empty());
+    }
+
+    // against the same keys in one IN list
+    vector<int> keys;
+    ostringstream in_query;
+    in_query << "select value from other_test_data where docid in (";
+    for (int docid=0; docid<100; ++docid)
+    {
+        keys.push_back(docid * 7 % 1000);
+        in_query << (docid ? "," : "") << keys.back();
+    }
+    in_query << ")";
+
+    const unsigned nloops = 100;
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned i=0; i<nloops; ++i)
+    {
+        BOOST_REQUIRE(fetcher.do_fetch(in_query.str(), val));
+        BOOST_REQUIRE(val.size() == keys.size());
+    }
+    std::chrono::duration<double> in_elapsed = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    for (unsigned i=0; i<nloops; ++i)
+    {
+        BOOST_REQUIRE(fetcher.multi_get(*prep_fetch, val, keys, key_ok));
+        BOOST_REQUIRE(val.size() == keys.size());
+    }
+    std::chrono::duration<double> multi_elapsed = std::chrono::steady_clock::now() - start;
+    BOOST_REQUIRE(val.front() == "test data0");
+    BOOST_REQUIRE(val.back() == "test data693");
+
+    BOOST_MESSAGE(nloops << " lookups of " << keys.size() << " keys: IN list " 
+                    << in_elapsed.count() << " sec, multi_get " << multi_elapsed.count() << " sec");
+}
+
+BOOST_AUTO_TEST_CASE(test_tuple_fetcher) 
+{
+    BOOST_REQUIRE(CassConn::truncate("other_test_data", consist));
+    PreparedStorePtr prep_store 
+            = CassConn::prepare_store("insert into other_test_data (docid, value) values(?, ?)", 2);
+    BOOST_REQUIRE(prep_store);
+    {
+        BulkWriter writer(prep_store);
+        for (unsigned docid=0; docid<nbench; ++docid)
+        {
+            BOOST_REQUIRE(writer.write(int(docid), string("test data")));
+        }
+        BOOST_REQUIRE(writer.flush());
+    }
+
+    {
+        TupleFetcher<cass_int32_t, string> fetcher;
+        std::tuple<cass_int32_t, string> row;
+        BOOST_REQUIRE(fetcher.do_fetch("select docid, value from other_test_data where docid=7", row));
+        BOOST_REQUIRE(std::get<0>(row) == 7);
+        BOOST_REQUIRE(std::get<1>(row) == "test data");
+        BOOST_REQUIRE(!fetcher.do_fetch("select docid, value from other_test_data where docid=-1", row));
+
+        // wrong type for the value column
+        TupleFetcher<cass_int32_t, cass_int64_t> bad_fetcher;
+        std::tuple<cass_int32_t, cass_int64_t> bad_row;
+        BOOST_REQUIRE(!bad_fetcher.do_fetch("select docid, value from other_test_data where docid=7", bad_row));
+    }
+    {
+        PreparedFetchPtr prep_fetch 
+                = CassConn::prepare_fetch("select docid, value from other_test_data where docid=?", 1);
+        BOOST_REQUIRE(prep_fetch);
+        RowFetcher<OtherDoc> fetcher;
+        OtherDoc doc;
+        BOOST_REQUIRE(fetcher.do_fetch(*prep_fetch, doc, 3));
+        BOOST_REQUIRE(doc.docid == 3);
+        BOOST_REQUIRE(doc.value == "test data");
+    }
+
+    // against a hand written fetcher over the whole table
+    auto start = std::chrono::steady_clock::now();
+    OtherDocFetcher hand_fetcher;
+    BOOST_REQUIRE(CassConn::fetch("select docid, value from other_test_data", hand_fetcher));
+    BOOST_REQUIRE(hand_fetcher.docs.size() == nbench);
+    std::chrono::duration<double> hand_elapsed = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    RowConFetcher<OtherDoc> con_fetcher;
+    vector<OtherDoc> docs;
+    BOOST_REQUIRE(con_fetcher.do_fetch("select docid, value from other_test_data", docs));
+    std::chrono::duration<double> row_elapsed = std::chrono::steady_clock::now() - start;
+    BOOST_REQUIRE(docs.size() == nbench);
+
+    TupleConFetcher<cass_int32_t, string> tuple_fetcher;
+    vector<std::tuple<cass_int32_t, string>> rows;
+    BOOST_REQUIRE(tuple_fetcher.do_fetch("select docid, value from other_test_data", rows, consist));
+    BOOST_REQUIRE(rows.size() == nbench);
+    int64_t sum = 0;
+    for (auto it = rows.begin(); it != rows.end(); ++it)
+    {
+        sum += std::get<0>(*it);
+    }
+    BOOST_REQUIRE(sum == int64_t(nbench) * (nbench - 1) / 2);
+
+    BOOST_MESSAGE("fetching " << nbench << " rows: hand written fetcher " << hand_elapsed.count() 
+                    << " sec, RowConFetcher " << row_elapsed.count() << " sec");
+}
+
+BOOST_AUTO_TEST_CASE(test_columnar_fetcher) 
+{
+    BOOST_REQUIRE(CassConn::truncate("prep_store", consist));
+    PreparedStorePtr prep_store 
+            = CassConn::prepare_store("insert into prep_store (int_key, int_value, double_value) values(?, ?, ?)", 3);
+    BOOST_REQUIRE(prep_store);
+
+    {
+        // a few rows with nulls first
+        BOOST_REQUIRE(CassConn::store("insert into prep_store (int_key, int_value) values(1, 10)", consist));
+        BOOST_REQUIRE(CassConn::store("insert into prep_store (int_key, double_value) values(2, 2.5)", consist));
+        ColumnarFetcher<cass_int32_t, cass_int32_t, cass_double_t> fetcher;
+        BOOST_REQUIRE(fetcher.do_fetch("select int_key, int_value, double_value from prep_store", consist));
+        BOOST_REQUIRE(fetcher.size() == 2);
+        BOOST_REQUIRE(fetcher.column<1>().has_nulls());
+        BOOST_REQUIRE(fetcher.column<2>().has_nulls());
+        BOOST_REQUIRE(!fetcher.column<0>().has_nulls());
+        for (size_t i=0; i<fetcher.size(); ++i)
         {
-            val.push_back(i);
+            bool is_one = fetcher.column<0>().values()[i] == 1;
+            BOOST_REQUIRE(fetcher.column<1>().is_null(i) == !is_one);
+            BOOST_REQUIRE(fetcher.column<2>().is_null(i) == is_one);
+            BOOST_REQUIRE(fetcher.column<1>().values()[i] == (is_one ? 10 : 0));
+            BOOST_REQUIRE(fetcher.column<2>().values()[i] == (is_one ? 0 : 2.5));
         }
-        test_prep_store_call(val, "blob_value");
+
+        // bool columns are a packed vector<bool>
+        BOOST_REQUIRE(CassConn::store("update prep_store set boolean_value=true where int_key=1", consist));
+        ColumnarFetcher<cass_int32_t, bool> bool_fetcher;
+        BOOST_REQUIRE(bool_fetcher.do_fetch("select int_key, boolean_value from prep_store", consist));
+        BOOST_REQUIRE(bool_fetcher.size() == 2);
+        for (size_t i=0; i<bool_fetcher.size(); ++i)
+        {
+            bool is_one = bool_fetcher.column<0>().values()[i] == 1;
+            BOOST_REQUIRE(bool_fetcher.column<1>().is_null(i) == !is_one);
+            BOOST_REQUIRE(bool_fetcher.column<1>().values()[i] == is_one);
+        }
+
+        // wrong type, the columns stay the same length
+        ColumnarFetcher<cass_int32_t, string> bad_fetcher;
+        BOOST_REQUIRE(!bad_fetcher.do_fetch("select int_key, double_value from prep_store where int_key=2"));
+        BOOST_REQUIRE(bad_fetcher.size() == 0);
+        BOOST_REQUIRE(bad_fetcher.column<1>().size() == 0);
+    }
+
+    // row-wise against columnar decode of an int/double result
+    const unsigned nrows = ncolumnar;
+    double expected_sum = 0;
+    BOOST_REQUIRE(CassConn::truncate("prep_store", consist));
+    {
+        BulkWriter writer(prep_store);
+        for (unsigned i=0; i<nrows; ++i)
+        {
+            BOOST_REQUIRE(writer.write(int(i), int(i % 1000), cass_double_t(i) / 4));
+            expected_sum += cass_double_t(i) / 4;
+        }
+        BOOST_REQUIRE(writer.flush());
+    }
+    const unsigned page_size = 10000;
+    const string query = "select int_value, double_value from prep_store";
+
+    auto start = std::chrono::steady_clock::now();
+    TupleConFetcher<cass_int32_t, cass_double_t> row_fetcher;
+    vector<std::tuple<cass_int32_t, cass_double_t>> rows;
+    BOOST_REQUIRE(row_fetcher.do_fetch_paged(query, rows, page_size));
+    std::chrono::duration<double> row_decode = std::chrono::steady_clock::now() - start;
+    start = std::chrono::steady_clock::now();
+    double row_sum = 0;
+    for (auto it = rows.begin(); it != rows.end(); ++it)
+    {
+        row_sum += std::get<1>(*it);
+    }
+    std::chrono::duration<double> row_sum_time = std::chrono::steady_clock::now() - start;
+    BOOST_REQUIRE(rows.size() == nrows);
+
+    start = std::chrono::steady_clock::now();
+    ColumnarFetcher<cass_int32_t, cass_double_t> col_fetcher;
+    BOOST_REQUIRE(CassConn::fetch_paged(query, col_fetcher, page_size));
+    std::chrono::duration<double> col_decode = std::chrono::steady_clock::now() - start;
+    start = std::chrono::steady_clock::now();
+    double col_sum = 0;
+    const vector<cass_double_t>& vals = col_fetcher.column<1>().values();
+    for (size_t i=0; i<vals.size(); ++i)
+    {
+        col_sum += vals[i];
+    }
+    std::chrono::duration<double> col_sum_time = std::chrono::steady_clock::now() - start;
+    BOOST_REQUIRE(col_fetcher.size() == nrows);
+
+    BOOST_REQUIRE(row_sum == col_sum);
+    BOOST_REQUIRE(col_sum == expected_sum);
+
+    BOOST_MESSAGE("decoding " << nrows << " int/double rows: row-wise " << row_decode.count() 
+                    << " sec + sum " << row_sum_time.count() << " sec, columnar " << col_decode.count() 
+                    << " sec + sum " << col_sum_time.count() << " sec");
+}
+
+BOOST_AUTO_TEST_CASE(test_column_index) 
+{
+    BOOST_REQUIRE(CassConn::truncate("other_test_data", consist));
+    BOOST_REQUIRE(CassConn::store("insert into other_test_data (docid, value) values(1, 'test data1')", consist));
+    BOOST_REQUIRE(CassConn::store("insert into other_test_data (docid, value) values(2, 'test data2')", consist));
+
+    {
+        NamedDocFetcher fetcher;
+        BOOST_REQUIRE(CassConn::fetch("select docid, value from other_test_data where docid=1", fetcher));
+        BOOST_REQUIRE(fetcher.cols.index(0) == 0);
+        BOOST_REQUIRE(fetcher.cols.index(1) == 1);
+        BOOST_REQUIRE(fetcher.docs.size() == 1);
+        BOOST_REQUIRE(fetcher.docs[0].docid == 1);
+        BOOST_REQUIRE(fetcher.docs[0].value == "test data1");
+    }
+    {
+        // same fetcher, other column order
+        NamedDocFetcher fetcher;
+        BOOST_REQUIRE(CassConn::fetch("select value, docid from other_test_data where docid=2", fetcher));
+        BOOST_REQUIRE(fetcher.cols.index(0) == 1);
+        BOOST_REQUIRE(fetcher.cols.index(1) == 0);
+        BOOST_REQUIRE(fetcher.docs.size() == 1);
+        BOOST_REQUIRE(fetcher.docs[0].docid == 2);
+        BOOST_REQUIRE(fetcher.docs[0].value == "test data2");
     }
     {
-        RefId val;
-        val.randomize();
-        test_prep_store_call(val, "uuid_value");
+        NamedDocFetcher fetcher;
+        BOOST_REQUIRE(!CassConn::fetch("select value from other_test_data where docid=2", fetcher));
+        BOOST_REQUIRE(fetcher.cols.index(0) == -1);
+        BOOST_REQUIRE(fetcher.docs.empty());
     }
+}
+
+BOOST_AUTO_TEST_CASE(test_fetch_result_views) 
+{
+    BOOST_REQUIRE(CassConn::truncate("blob_data", consist));
+    PreparedStorePtr prep_store 
+            = CassConn::prepare_store("insert into blob_data (docid, value) values(?, ?)", 2);
+    BOOST_REQUIRE(prep_store);
+
+    const unsigned nblobs = 200;
+    const string blob(64*1024, 'x');
     {
-        bool val = cass_false;
-        test_prep_store_call(val, "boolean_value");
-        val = cass_true;
-        test_prep_store_call(val, "boolean_value");
+        BulkWriter writer(prep_store);
+        for (unsigned docid=0; docid<nblobs; ++docid)
+        {
+            BOOST_REQUIRE(writer.write(int(docid), as_bytes(blob.data(), blob.size())));
+        }
+        BOOST_REQUIRE(writer.flush());
     }
+
+    CassResultPtr result;
     {
-        float val = 3.14159;
-        test_prep_store_call(val, "float_value");
+        BlobFetcher<CassBytes> fetcher;
+        BOOST_REQUIRE(CassConn::fetch_result("select value from blob_data where docid=1", fetcher, result));
+        BOOST_REQUIRE(result);
+        BOOST_REQUIRE(fetcher.blobs.size() == 1);
+        BOOST_REQUIRE(fetcher.blobs[0].size == blob.size());
+        BOOST_REQUIRE(!memcmp(fetcher.blobs[0].data, blob.data(), blob.size()));
+
+        BlobFetcher<CassString> text_fetcher;
+        BOOST_REQUIRE(CassConn::fetch_result("select blobAsText(value) from blob_data where docid=1", 
+                                             text_fetcher, result, consist));
+        BOOST_REQUIRE(string(text_fetcher.blobs[0].data, text_fetcher.blobs[0].length) == blob);
+
+        BOOST_REQUIRE(!CassConn::fetch_result("select value from no_table", fetcher, result));
+        BOOST_REQUIRE(!result);
     }
+
+    // copies against views of every blob
+    auto start = std::chrono::steady_clock::now();
+    BlobFetcher<CassBytesMgr> copy_fetcher;
+    BOOST_REQUIRE(CassConn::fetch("select value from blob_data", copy_fetcher));
+    std::chrono::duration<double> copy_elapsed = std::chrono::steady_clock::now() - start;
+    BOOST_REQUIRE(copy_fetcher.blobs.size() == nblobs);
+
+    start = std::chrono::steady_clock::now();
+    BlobFetcher<CassBytes> view_fetcher;
+    BOOST_REQUIRE(CassConn::fetch_result("select value from blob_data", view_fetcher, result));
+    std::chrono::duration<double> view_elapsed = std::chrono::steady_clock::now() - start;
+    BOOST_REQUIRE(view_fetcher.blobs.size() == nblobs);
+
+    // views stay good while a copy of the result is held
+    CassResultPtr held = result;
+    result.reset();
+    for (auto it = view_fetcher.blobs.begin(); it != view_fetcher.blobs.end(); ++it)
     {
-        double val = 10000003.14159;
-        test_prep_store_call(val, "double_value");
+        BOOST_REQUIRE(it->size == blob.size() && !memcmp(it->data, blob.data(), blob.size()));
     }
+
+    BOOST_MESSAGE("fetching " << nblobs << " blobs of " << blob.size() << " bytes: copied " 
+                    << copy_elapsed.count() << " sec, views " << view_elapsed.count() << " sec");
+}
+
+BOOST_AUTO_TEST_CASE(test_fetch_each) 
+{
+    BOOST_REQUIRE(CassConn::truncate("other_test_data", consist));
+    PreparedStorePtr prep_store 
+            = CassConn::prepare_store("insert into other_test_data (docid, value) values(?, ?)", 2);
+    BOOST_REQUIRE(prep_store);
     {
-        int val = 123456;
-        test_prep_store_call(val, "int_value");
+        BulkWriter writer(prep_store);
+        for (unsigned docid=0; docid<nbench; ++docid)
+        {
+            BOOST_REQUIRE(writer.write(int(docid), string("test data")));
+        }
+        BOOST_REQUIRE(writer.flush());
     }
+    const int64_t expected_sum = int64_t(nbench) * (nbench - 1) / 2;
+
+    int64_t sum = 0;
+    BOOST_REQUIRE(CassConn::fetch_each("select docid from other_test_data", 
+                                       [&](const CassRow& row)
+                                       {
+                                           cass_int32_t docid = 0;
+                                           bool retVal = FetchHelper::get_nth(0, docid, row);
+                                           sum += docid;
+                                           return retVal;
+                                       }, consist));
+    BOOST_REQUIRE(sum == expected_sum);
+
+    // stops at false or a throw
+    unsigned nrows = 0;
+    BOOST_REQUIRE(!CassConn::fetch_each("select docid from other_test_data", 
+                                        [&](const CassRow& row) { return ++nrows < 10; }));
+    BOOST_REQUIRE(nrows == 10);
+    BOOST_REQUIRE(!CassConn::fetch_each("select docid from other_test_data", 
+                                        [&](const CassRow& row) -> bool { throw std::runtime_error("stop"); }));
+    BOOST_REQUIRE(!CassConn::fetch_each("select docid from no_table", 
+                                        [&](const CassRow& row) { return true; }));
+
+    // per row cost of the virtual CassFetcher::fetch against an inlined lambda,
+    // over the same result so the network is not in it
+    CassResultPtr result;
+    BOOST_REQUIRE(CassConn::fetch_result("select docid from other_test_data", result));
+    const unsigned nloops = 100;
+
+    boost::shared_ptr<CountFetcher> count_fetcher = boost::make_shared<CountFetcher>();
+    CassFetcherPtr fetcher = count_fetcher;
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned i=0; i<nloops; ++i)
     {
-        cass_uint8_t address[CASS_INET_V4_LENGTH] = {127,0,0,1};
-        CassInet val = cass_inet_init_v4(address);
-        test_prep_store_call(val, "inet_value");
+        BOOST_REQUIRE(CassConn::for_each_row(result, [&](const CassRow& row) { return fetcher->fetch(row); }));
     }
+    std::chrono::duration<double> virtual_elapsed = std::chrono::steady_clock::now() - start;
+    BOOST_REQUIRE(count_fetcher->sum == nloops * expected_sum);
+
+    sum = 0;
+    start = std::chrono::steady_clock::now();
+    for (unsigned i=0; i<nloops; ++i)
     {
-        cass_uint8_t address[CASS_INET_V6_LENGTH] = {127,0,0,1,6,7};
-        CassInet val = cass_inet_init_v6(address);
-        test_prep_store_call(val, "inet_value");
+        BOOST_REQUIRE(CassConn::for_each_row(result, 
+                                             [&](const CassRow& row)
+                                             {
+                                                 int val = 0;
+                                                 bool retVal = FetchHelper::get_nth(0, val, row);
+                                                 sum += val;
+                                                 return retVal;
+                                             }));
     }
+    std::chrono::duration<double> inline_elapsed = std::chrono::steady_clock::now() - start;
+    BOOST_REQUIRE(sum == nloops * expected_sum);
+
+    double nrows_total = double(nloops) * nbench;
+    BOOST_MESSAGE("per row over " << nrows_total << " rows: virtual fetch " 
+                    << virtual_elapsed.count() * 1e9 / nrows_total << " ns, inlined lambda "
+                    << inline_elapsed.count() * 1e9 / nrows_total << " ns");
+}
+
+BOOST_AUTO_TEST_CASE(test_async_fetch_callback) 
+{
+    BOOST_REQUIRE(CassConn::truncate("other_test_data", consist));
+    PreparedStorePtr prep_store 
+            = CassConn::prepare_store("insert into other_test_data (docid, value) values(?, ?)", 2);
+    BOOST_REQUIRE(prep_store);
+    const int nkeys = 1000;
     {
-        vector<int> val = {1,2,3,4,11,9,8};
-        test_prep_store_call(val, "list_value");
+        BulkWriter writer(prep_store);
+        for (int docid=0; docid<nkeys; ++docid)
+        {
+            ostringstream value;
+            value << "test data" << docid;
+            BOOST_REQUIRE(writer.write(docid, value.str()));
+        }
+        BOOST_REQUIRE(writer.flush());
     }
+    PreparedFetchPtr prep_fetch 
+            = CassConn::prepare_fetch("select value from other_test_data where docid=?", 1);
+    BOOST_REQUIRE(prep_fetch);
+
+    std::mutex mutex;
+    std::condition_variable done_cond;
+    unsigned num_done = 0;
+    unsigned num_ok = 0;
+    auto count_done = [&](bool ok, CassFetcherPtr fetcher)
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        ++num_done;
+        num_ok += ok && fetcher && fetcher->was_set();
+        done_cond.notify_all();
+    };
+    auto wait_done = [&](unsigned n)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        return done_cond.wait_for(lock, std::chrono::seconds(10), [&]() { return num_done >= n; });
+    };
+
+    // rows go through the fetcher and the callback on the driver thread
+    string val1;
+    CassFetcherHolderPtr holder1 = async_fetch("select value from other_test_data where docid=1", val1);
+    BOOST_REQUIRE(holder1->on_complete(count_done));
+    BOOST_REQUIRE(wait_done(1));
+    BOOST_REQUIRE(num_ok == 1);
+    BOOST_REQUIRE(val1 == "test data1");
+
+    // and on a pool thread, not the driver's
+    WorkerPool pool(1);
+    std::thread::id pool_thread;
+    pool.post([&]() { pool_thread = std::this_thread::get_id(); });
+    pool.wait();
+    string val2;
+    std::thread::id callback_thread;
+    CassFetcherHolderPtr holder2 = boost::make_shared<CassFetcherHolder>();
+    BOOST_REQUIRE(prep_fetch->async_fetch(boost::make_shared<FetcherAsync<string>>("", val2), holder2, 2));
+    BOOST_REQUIRE(holder2->on_complete([&](bool ok, CassFetcherPtr fetcher)
+                                       {
+                                           callback_thread = std::this_thread::get_id();
+                                           count_done(ok, fetcher);
+                                       }, pool));
+    BOOST_REQUIRE(wait_done(2));
+    BOOST_REQUIRE(num_ok == 2);
+    BOOST_REQUIRE(val2 == "test data2");
+    BOOST_REQUIRE(callback_thread == pool_thread);
+
+    // a fetch already picked up calls back right away
+    bool was_called = false;
+    BOOST_REQUIRE(holder1->on_complete([&](bool ok, CassFetcherPtr fetcher) { was_called = ok; }));
+    BOOST_REQUIRE(was_called);
+
+    // failures are reported too
+    string bad_val;
+    CassFetcherHolderPtr bad_holder = async_fetch("select value from no_table where docid=1", bad_val);
+    BOOST_REQUIRE(bad_holder->on_complete(count_done));
+    BOOST_REQUIRE(wait_done(3));
+    BOOST_REQUIRE(num_ok == 2);
+
+    // nkeys lookups with up to max_in_flight at once: the issuing thread waiting on
+    // each holder in turn, against callbacks on the pool
+    const unsigned max_in_flight = 64;
+    vector<string> vals(nkeys);
+    auto start = std::chrono::steady_clock::now();
     {
-        list<int> val = {9,3,1,3,9};
-        test_prep_store_call(val, "list_value");
+        std::deque<CassFetcherHolderPtr> in_flight;
+        for (int docid=0; docid<nkeys; ++docid)
+        {
+            if (in_flight.size() == max_in_flight)
+            {
+                BOOST_REQUIRE(in_flight.front()->was_set());
+                in_flight.pop_front();
+            }
+            CassFetcherHolderPtr holder = boost::make_shared<CassFetcherHolder>();
+            BOOST_REQUIRE(prep_fetch->async_fetch(boost::make_shared<FetcherAsync<string>>("", vals[docid]), 
+                                                  holder, docid));
+            in_flight.push_back(holder);
+        }
+        for (auto it = in_flight.begin(); it != in_flight.end(); ++it)
+        {
+            BOOST_REQUIRE((*it)->was_set());
+        }
     }
+    std::chrono::duration<double> wait_elapsed = std::chrono::steady_clock::now() - start;
+    BOOST_REQUIRE(vals[nkeys - 1] == "test data999");
+
+    vals.assign(nkeys, string());
+    num_done = 0;
+    num_ok = 0;
+    start = std::chrono::steady_clock::now();
+    for (int docid=0; docid<nkeys; ++docid)
     {
-        set<int> val = {1,2,3,5,7,9,11};
-        test_prep_store_call(val, "set_value");
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            BOOST_REQUIRE(done_cond.wait_for(lock, std::chrono::seconds(10), 
+                                             [&]() { return docid - num_done < max_in_flight; }));
+        }
+        CassFetcherHolderPtr holder = boost::make_shared<CassFetcherHolder>();
+        BOOST_REQUIRE(prep_fetch->async_fetch(boost::make_shared<FetcherAsync<string>>("", vals[docid]), 
+                                              holder, docid));
+        BOOST_REQUIRE(holder->on_complete(count_done, pool));
     }
+    BOOST_REQUIRE(wait_done(nkeys));
+    std::chrono::duration<double> callback_elapsed = std::chrono::steady_clock::now() - start;
+    BOOST_REQUIRE(num_ok == unsigned(nkeys));
+    BOOST_REQUIRE(vals[nkeys - 1] == "test data999");
+
+    BOOST_MESSAGE(nkeys << " async lookups, " << max_in_flight << " in flight: waiting on holders "
+                    << wait_elapsed.count() << " sec, on_complete callbacks " 
+                    << callback_elapsed.count() << " sec");
+}
+
+BOOST_AUTO_TEST_CASE(test_reprepare) 
+{
+    const string create_table = "create table if not exists reprepare_data (docid int primary key, value text)";
+    BOOST_REQUIRE(CassConn::change(create_table));
+    PreparedStorePtr prep_store 
+            = CassConn::prepare_store("insert into reprepare_data (docid, value) values(?, ?)", 2);
+    BOOST_REQUIRE(prep_store);
+    PreparedFetchPtr prep_fetch 
+            = CassConn::prepare_fetch("select value from reprepare_data where docid=?", 1);
+    BOOST_REQUIRE(prep_fetch);
+    BOOST_REQUIRE(prep_store->store(1, string("before")));
+
+    // dropping the table drops its prepared statements on the server
+    BOOST_REQUIRE(CassConn::change("drop table reprepare_data"));
+    BOOST_REQUIRE(CassConn::change(create_table));
+    CassConn::FullStats stats;
+    CassConn::get_stats(stats);     // clear current stats
+
+    BOOST_REQUIRE(prep_store->store(1, string("after")));
+    Fetcher<string> fetcher;
+    string val;
+    BOOST_REQUIRE(fetcher.do_fetch(*prep_fetch, val, 1));
+    BOOST_REQUIRE(val == "after");
+
+    // each counted once as a good call, the unprepared attempt is not a bad one
+    CassConn::get_stats(stats);
+    BOOST_REQUIRE(stats.m_stored.m_call == 1);
+    BOOST_REQUIRE(stats.m_stored.m_bad == 0);
+    BOOST_REQUIRE(stats.m_stored.m_reprepare == 1);
+    BOOST_REQUIRE(stats.m_fetched.m_call == 1);
+    BOOST_REQUIRE(stats.m_fetched.m_bad == 0);
+    BOOST_REQUIRE(stats.m_fetched.m_reprepare == 1);
+
+    // async stores report it, for the caller to prepare again
+    BOOST_REQUIRE(CassConn::change("drop table reprepare_data"));
+    BOOST_REQUIRE(CassConn::change(create_table));
+    StoreHolderPtr holder(new StoreHolder());
+    BOOST_REQUIRE(prep_store->async_store(holder, 2, string("async")));
+    BOOST_REQUIRE(!holder->wait());
+    BOOST_REQUIRE(holder->was_unprepared());
+    BOOST_REQUIRE(prep_store->reprepare());
+    BOOST_REQUIRE(prep_store->async_store(holder, 2, string("async")));
+    BOOST_REQUIRE(holder->wait());
+    BOOST_REQUIRE(!holder->was_unprepared());
+    BOOST_REQUIRE(fetcher.do_fetch(*prep_fetch, val, 2));
+    BOOST_REQUIRE(val == "async");
+
+    // BulkWriter prepares again and binds each store again from the new prepared,
+    // from its own copy of views whose data was reused after write
+    BOOST_REQUIRE(CassConn::change("drop table reprepare_data"));
+    BOOST_REQUIRE(CassConn::change(create_table));
     {
-        map<int,int> val = { {1,2}, {2,4}, {4,8}};
-        test_prep_store_call(val, "map_value");
+        BulkWriter writer(prep_store);
+        char buffer[] = "bulk";
+        for (int docid=10; docid<20; ++docid)
+        {
+            BOOST_REQUIRE(writer.write(docid, as_text(buffer, 4)));
+        }
+        memcpy(buffer, "gone", 4);
+        BOOST_REQUIRE(writer.flush());
+        BOOST_REQUIRE(writer.summary().m_written == 10);
+        BOOST_REQUIRE(writer.summary().m_failed == 0);
+        BOOST_REQUIRE(writer.summary().m_retried > 0);
     }
+    BOOST_REQUIRE(fetcher.do_fetch(*prep_fetch, val, 19));
+    BOOST_REQUIRE(val == "bulk");
 }
 
 BOOST_AUTO_TEST_SUITE_END()
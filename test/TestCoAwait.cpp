@@ -0,0 +1,249 @@
+#include <boost/program_options.hpp>
+#include <boost/test/unit_test.hpp>
+#include "cql-interface/cql-interface.h"
+
+// the awaitables need C++20, build with -DUSE_CXX20=1
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+#include "log4cxx/logger.h"
+
+using namespace log4cxx;
+using namespace log4cxx::helpers;
+
+using namespace std;
+using namespace cb::cass_util;
+using namespace cb;
+
+extern unsigned nbench;
+extern unsigned nthreads;
+
+namespace
+{
+    static log4cxx::LoggerPtr logger(Logger::getLogger("cb.co_await_test"));
+
+    // use this consistency for the tests
+    CassConsistency consist = CASS_CONSISTENCY_ONE;
+
+    // fire and forget coroutine, it runs until its first co_await right away
+    struct CoTask
+    {
+        struct promise_type
+        {
+            CoTask get_return_object() { return CoTask(); }
+            std::suspend_never initial_suspend() noexcept { return {}; }
+            std::suspend_never final_suspend() noexcept { return {}; }
+            void return_void() {}
+            void unhandled_exception() { std::terminate(); }
+        };
+    };
+
+    // counts finished coroutines, for the test thread to wait on
+    class DoneCount
+    {
+    public:
+
+        void add()
+        {
+            std::lock_guard<std::mutex> guard(m_mutex);
+            ++m_num_done;
+            m_cond.notify_all();
+        }
+
+        bool wait_for(unsigned num_done)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            return m_cond.wait_for(lock, std::chrono::seconds(30), [&]() { return m_num_done >= num_done; });
+        }
+
+    private:
+
+        std::mutex m_mutex;
+        std::condition_variable m_cond;
+        unsigned m_num_done = 0;
+    };
+
+    struct RoundTrip
+    {
+        bool stored = false;
+        bool fetched = false;
+        string value;
+        bool missing_fetched = true;
+        bool bad_fetched = true;
+        bool bad_stored = true;
+    };
+
+    CoTask round_trip(RoundTrip& result, DoneCount& done)
+    {
+        result.stored = co_await co_store("insert into other_test_data (docid, value) values(1, 'co data1')");
+        result.fetched = co_await co_fetch_value("select value from other_test_data where docid=1", result.value);
+        string missing;
+        result.missing_fetched = co_await co_fetch_value("select value from other_test_data where docid=2", missing);
+        string bad;
+        result.bad_fetched = co_await co_fetch_value("select value from no_table where docid=1", bad);
+        result.bad_stored = co_await co_store("insert into no_table (docid, value) values(1, 'x')");
+        done.add();
+    }
+
+    struct PoolTrip
+    {
+        bool stored = true;
+        bool fetched = false;
+        vector<string> values;
+        std::thread::id store_thread;
+        std::thread::id fetch_thread;
+    };
+
+    CoTask pool_trip(PreparedStore& prep_store, PoolTrip& result, WorkerPool& pool, DoneCount& done)
+    {
+        for (int docid=10; docid<15; ++docid)
+        {
+            result.stored = result.stored
+                            && co_await co_store(prep_store, docid, string("co prep data")).resume_on(pool);
+        }
+        result.store_thread = std::this_thread::get_id();
+        result.fetched = co_await co_fetch_con<string>("select value from other_test_data", result.values)
+                                     .resume_on(pool);
+        result.fetch_thread = std::this_thread::get_id();
+        done.add();
+    }
+
+    // one of many coroutines looking up the keys from next until num_keys,
+    // one at a time each
+    CoTask lookup_keys(PreparedFetch& prep_fetch, std::atomic<int>& next, int num_keys,
+                       std::atomic<unsigned>& num_found, WorkerPool& pool, DoneCount& done)
+    {
+        string value;
+        for (int docid = next++; docid < num_keys; docid = next++)
+        {
+            if (co_await co_fetch_value(prep_fetch, value, docid).resume_on(pool))
+            {
+                ++num_found;
+            }
+        }
+        done.add();
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE( CoAwaitTests )
+
+BOOST_AUTO_TEST_CASE(test_co_await)
+{
+    BOOST_REQUIRE(CassConn::truncate("other_test_data", consist));
+
+    // resumed on the driver threads
+    {
+        RoundTrip result;
+        DoneCount done;
+        round_trip(result, done);
+        BOOST_REQUIRE(done.wait_for(1));
+        BOOST_REQUIRE(result.stored);
+        BOOST_REQUIRE(result.fetched);
+        BOOST_REQUIRE(result.value == "co data1");
+        BOOST_REQUIRE(!result.missing_fetched);
+        BOOST_REQUIRE(!result.bad_fetched);
+        BOOST_REQUIRE(!result.bad_stored);
+    }
+
+    // prepared stores and a container fetch, resumed on a pool thread
+    {
+        PreparedStorePtr prep_store
+                = CassConn::prepare_store("insert into other_test_data (docid, value) values(?, ?)", 2);
+        BOOST_REQUIRE(prep_store);
+        WorkerPool pool(1);
+        std::thread::id pool_thread;
+        pool.post([&]() { pool_thread = std::this_thread::get_id(); });
+        pool.wait();
+
+        PoolTrip result;
+        DoneCount done;
+        pool_trip(*prep_store, result, pool, done);
+        BOOST_REQUIRE(done.wait_for(1));
+        BOOST_REQUIRE(result.stored);
+        BOOST_REQUIRE(result.fetched);
+        BOOST_REQUIRE(result.values.size() == 6);
+        BOOST_REQUIRE(std::count(result.values.begin(), result.values.end(), "co prep data") == 5);
+        BOOST_REQUIRE(result.store_thread == pool_thread);
+        BOOST_REQUIRE(result.fetch_thread == pool_thread);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_co_await_bench)
+{
+    BOOST_REQUIRE(CassConn::truncate("other_test_data", consist));
+    PreparedStorePtr prep_store
+            = CassConn::prepare_store("insert into other_test_data (docid, value) values(?, ?)", 2);
+    BOOST_REQUIRE(prep_store);
+    const int num_keys = int(nbench);
+    {
+        BulkWriter writer(prep_store);
+        for (int docid=0; docid<num_keys; ++docid)
+        {
+            BOOST_REQUIRE(writer.write(docid, string("test data")));
+        }
+        BOOST_REQUIRE(writer.flush());
+    }
+    PreparedFetchPtr prep_fetch
+            = CassConn::prepare_fetch("select value from other_test_data where docid=?", 1);
+    BOOST_REQUIRE(prep_fetch);
+
+    // nthreads threads each waiting on one lookup at a time
+    std::atomic<int> next(0);
+    std::atomic<unsigned> num_found(0);
+    auto start = std::chrono::steady_clock::now();
+    {
+        vector<std::thread> threads;
+        for (unsigned i=0; i<nthreads; ++i)
+        {
+            threads.emplace_back([&]()
+            {
+                Fetcher<string> fetcher;
+                string value;
+                for (int docid = next++; docid < num_keys; docid = next++)
+                {
+                    if (fetcher.do_fetch(*prep_fetch, value, docid))
+                    {
+                        ++num_found;
+                    }
+                }
+            });
+        }
+        for (auto it = threads.begin(); it != threads.end(); ++it)
+        {
+            it->join();
+        }
+    }
+    std::chrono::duration<double> thread_elapsed = std::chrono::steady_clock::now() - start;
+    BOOST_REQUIRE(num_found == unsigned(num_keys));
+
+    // the same lookups from many coroutines on 2 threads, keeping under the driver queue
+    const unsigned num_coroutines = std::max(1u, std::min(1000u, CassConn::get_queue_size_io() / 2));
+    WorkerPool pool(2);
+    DoneCount done;
+    next = 0;
+    num_found = 0;
+    start = std::chrono::steady_clock::now();
+    for (unsigned i=0; i<num_coroutines; ++i)
+    {
+        lookup_keys(*prep_fetch, next, num_keys, num_found, pool, done);
+    }
+    BOOST_REQUIRE(done.wait_for(num_coroutines));
+    std::chrono::duration<double> co_elapsed = std::chrono::steady_clock::now() - start;
+    BOOST_REQUIRE(num_found == unsigned(num_keys));
+
+    BOOST_MESSAGE(num_keys << " prepared lookups: " << nthreads << " threads waiting on fetches "
+                    << thread_elapsed.count() << " sec, " << num_coroutines << " coroutines on "
+                    << pool.size() << " threads " << co_elapsed.count() << " sec");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+#endif
@@ -0,0 +1,151 @@
+#include <boost/program_options.hpp>
+#include <boost/test/unit_test.hpp>
+#include "cql-interface/cql-interface.h"
+#include "cql-interface/CqlTemplate.h"
+#include "cql-interface/StatementCache.h"
+
+#include "log4cxx/logger.h"
+
+using namespace log4cxx;
+using namespace log4cxx::helpers;
+
+using namespace std;
+using namespace cb::cass_util;
+using namespace cb;
+
+namespace
+{
+    static log4cxx::LoggerPtr logger(Logger::getLogger("cb.cql_template_test"));
+
+    string kinds(const CqlTemplate& cql)
+    {
+        string retVal;
+        for (auto it = cql.literals().begin(); it != cql.literals().end(); ++it)
+        {
+            retVal.append(1, char(it->m_kind));
+        }
+        return retVal;
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE( CqlTemplateTests )
+
+BOOST_AUTO_TEST_CASE(test_cql_template_numbers)
+{
+    // numbers are left in the text, their column type can't be told from them
+    CqlTemplate cql;
+    BOOST_REQUIRE(cql.parse("select value from other_test_data where docid in (1, 2,-3)"));
+    BOOST_REQUIRE_MESSAGE(cql.text() == "select value from other_test_data where docid in (1, 2,-3)",
+                          "cql.text()[" << cql.text() << "]");
+    BOOST_REQUIRE(kinds(cql) == "");
+
+    BOOST_REQUIRE(cql.parse("insert into prep_store (int_key, bigint_value, double_value, text_value) "
+                            "values(7, 1233424332344, 3.5e-2, 'x')"));
+    BOOST_REQUIRE_MESSAGE(cql.text() == "insert into prep_store (int_key, bigint_value, double_value, text_value) "
+                                        "values(7, 1233424332344, 3.5e-2, ?)",
+                          "cql.text()[" << cql.text() << "]");
+    BOOST_REQUIRE(kinds(cql) == "s");
+
+    // identifiers with digits are left alone
+    BOOST_REQUIRE(cql.parse("select value1 from table2 where docid=3"));
+    BOOST_REQUIRE(cql.text() == "select value1 from table2 where docid=3");
+    BOOST_REQUIRE(kinds(cql) == "");
+}
+
+BOOST_AUTO_TEST_CASE(test_cql_template_strings)
+{
+    CqlTemplate cql;
+    BOOST_REQUIRE(cql.parse("insert into other_test_data (docid, value) values(1, 'line1\nit''s')"));
+    BOOST_REQUIRE(cql.text() == "insert into other_test_data (docid, value) values(?, ?)");
+    BOOST_REQUIRE(kinds(cql) == "is");
+    BOOST_REQUIRE_MESSAGE(cql.literals()[1].m_text == "line1\nit's",
+                          "m_text[" << cql.literals()[1].m_text << "]");
+
+    BOOST_REQUIRE(cql.parse("update \"Odd Table\" set value = $$a 'b'$$, flag = true where docid = 0x0aFF"));
+    BOOST_REQUIRE_MESSAGE(cql.text() == "update \"Odd Table\" set value = ?, flag = ? where docid = ?",
+                          "cql.text()[" << cql.text() << "]");
+    BOOST_REQUIRE(kinds(cql) == "sbx");
+    BOOST_REQUIRE(cql.literals()[0].m_text == "a 'b'");
+    BOOST_REQUIRE(cql.literals()[1].m_int == 1);
+    BOOST_REQUIRE(cql.literals()[2].m_text == string("\x0a\xff"));
+
+    // unterminated string
+    BOOST_REQUIRE(!cql.parse("select value from other_test_data where value = 'abc"));
+}
+
+BOOST_AUTO_TEST_CASE(test_cql_template_uuid)
+{
+    CqlTemplate cql;
+    RefId refid;
+    refid.randomize();
+    ostringstream query;
+    query << "select * from test_data where docid = " << refid;
+    BOOST_REQUIRE(cql.parse(query.str()));
+    BOOST_REQUIRE(cql.text() == "select * from test_data where docid = ?");
+    BOOST_REQUIRE(kinds(cql) == "u");
+    BOOST_REQUIRE_MESSAGE(cql.literals()[0].m_uuid == refid,
+                          cql.literals()[0].m_uuid << " == " << refid);
+}
+
+BOOST_AUTO_TEST_CASE(test_cql_template_key)
+{
+    CqlTemplate cql1;
+    CqlTemplate cql2;
+    BOOST_REQUIRE(cql1.parse("update other_test_data set value='a' where docid=1"));
+    BOOST_REQUIRE(cql2.parse("update other_test_data set value='b' where docid=1"));
+    BOOST_REQUIRE(cql1.key() == cql2.key());
+
+    // same text, other literal type
+    BOOST_REQUIRE(cql2.parse("update other_test_data set value=0x0a where docid=1"));
+    BOOST_REQUIRE(cql1.text() == cql2.text());
+    BOOST_REQUIRE(cql1.key() != cql2.key());
+
+    // other numbers are other statements
+    BOOST_REQUIRE(cql2.parse("update other_test_data set value='a' where docid=2"));
+    BOOST_REQUIRE(cql1.key() != cql2.key());
+}
+
+BOOST_AUTO_TEST_CASE(test_cql_template_skipped)
+{
+    CqlTemplate cql;
+    BOOST_REQUIRE(!cql.parse("truncate other_test_data"));
+    BOOST_REQUIRE(!cql.parse("Use cql_interface_test"));
+    BOOST_REQUIRE(!cql.parse("create table t (docid int primary key)"));
+    BOOST_REQUIRE(!cql.parse("select value from other_test_data where docid=?"));
+    BOOST_REQUIRE(!cql.parse("select value from other_test_data -- comment"));
+    BOOST_REQUIRE(!cql.parse(""));
+}
+
+BOOST_AUTO_TEST_CASE(test_statement_cache_lru)
+{
+    StatementCache cache;
+    BOOST_REQUIRE(!cache.enabled());
+    cache.insert(std::make_shared<StatementCache::Entry>("a", nullptr));
+    BOOST_REQUIRE(cache.size() == 0);
+
+    cache.set_max_entries(2);
+    BOOST_REQUIRE(cache.enabled());
+    cache.insert(std::make_shared<StatementCache::Entry>("a", nullptr));
+    cache.insert(std::make_shared<StatementCache::Entry>("b", nullptr));
+    BOOST_REQUIRE(cache.find("a"));        // a is now most recent
+    cache.insert(std::make_shared<StatementCache::Entry>("c", nullptr));
+    BOOST_REQUIRE(cache.size() == 2);
+    BOOST_REQUIRE(!cache.find("b"));
+    BOOST_REQUIRE(cache.find("a"));
+    BOOST_REQUIRE(cache.find("c"));
+
+    uint64_t hit = 0, miss = 0, evict = 0;
+    cache.take_stats(hit, miss, evict);
+    BOOST_REQUIRE(hit == 3);
+    BOOST_REQUIRE(miss == 1);
+    BOOST_REQUIRE(evict == 1);
+
+    cache.set_max_entries(0);
+    BOOST_REQUIRE(cache.size() == 0);
+    cache.take_stats(hit, miss, evict);
+    BOOST_REQUIRE(evict == 2);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
@@ -0,0 +1,252 @@
+#include <boost/program_options.hpp>
+#include <boost/test/unit_test.hpp>
+#include <atomic>
+#include "cql-interface/cql-interface.h"
+
+#include "log4cxx/logger.h"
+
+using namespace log4cxx;
+using namespace log4cxx::helpers;
+
+using namespace std;
+using namespace cb::cass_util;
+using namespace cb;
+
+extern unsigned nbench;
+
+// heap allocations in the test program, counted in TestCassandra.cpp
+extern std::atomic<uint64_t> num_news;
+
+namespace
+{
+    static log4cxx::LoggerPtr logger(Logger::getLogger("cb.fetch_arena_test"));
+
+    // use this consistency for the tests
+    CassConsistency consist = CASS_CONSISTENCY_ONE;
+
+    struct CollRow
+    {
+        cass_int32_t docid;
+        vector<cass_int32_t> value_list;
+        set<cass_int32_t> value_set;
+        map<cass_int32_t, cass_int32_t> value_map;
+    };
+
+    class CollFetcher : public CassFetcher
+    {
+    public:
+
+        virtual bool fetch(const CassRow& row)
+        {
+            rows.emplace_back();
+            CollRow& obj = rows.back();
+            return FetchHelper::get_columns(row, obj.docid, obj.value_list, obj.value_set, obj.value_map);
+        }
+
+        vector<CollRow> rows;
+    };
+
+    struct ArenaCollRow
+    {
+        cass_int32_t docid;
+        ArenaArray<cass_int32_t> value_list;
+        ArenaArray<cass_int32_t> value_set;
+        ArenaArray<pair<cass_int32_t, cass_int32_t>> value_map;
+    };
+
+    class ArenaCollFetcher : public CassFetcher
+    {
+    public:
+
+        virtual bool fetch(const CassRow& row)
+        {
+            rows.emplace_back();
+            ArenaCollRow& obj = rows.back();
+            return ArenaFetchHelper::get_nth(0, obj.docid, row, arena)
+                    && ArenaFetchHelper::get_nth(1, obj.value_list, row, arena)
+                    && ArenaFetchHelper::get_nth(2, obj.value_set, row, arena)
+                    && ArenaFetchHelper::get_nth(3, obj.value_map, row, arena);
+        }
+
+        // keeps the capacity of rows and arena for the next fetch
+        void reset()
+        {
+            rows.clear();
+            arena.reset();
+        }
+
+        vector<ArenaCollRow> rows;
+        FetchArena arena;
+    };
+
+    class BlobsFetcher : public CassFetcher
+    {
+    public:
+
+        virtual bool fetch(const CassRow& row)
+        {
+            blobs.emplace_back();
+            return FetchHelper::get_nth(0, blobs.back(), row);
+        }
+
+        vector<CassBytesMgr> blobs;
+    };
+
+    class ArenaBlobsFetcher : public CassFetcher
+    {
+    public:
+
+        virtual bool fetch(const CassRow& row)
+        {
+            blobs.emplace_back();
+            return ArenaFetchHelper::get_nth(0, blobs.back(), row, arena);
+        }
+
+        void reset()
+        {
+            blobs.clear();
+            arena.reset();
+        }
+
+        vector<ArenaBytes> blobs;
+        FetchArena arena;
+    };
+}
+
+
+BOOST_AUTO_TEST_SUITE( FetchArenaTests )
+
+BOOST_AUTO_TEST_CASE(test_fetch_arena)
+{
+    FetchArena arena(1024);
+    BOOST_REQUIRE(arena.used() == 0);
+
+    char* text = arena.allocate_array<char>(3);
+    double* nums = arena.allocate_array<double>(10);
+    BOOST_REQUIRE(reinterpret_cast<uintptr_t>(nums) % alignof(double) == 0);
+    BOOST_REQUIRE(reinterpret_cast<char*>(nums) >= text + 3);
+    BOOST_REQUIRE(arena.num_block_allocs() == 1);
+
+    // bigger than a block gets its own
+    char* big = arena.allocate_array<char>(5000);
+    big[4999] = 1;
+    BOOST_REQUIRE(arena.num_block_allocs() == 2);
+    BOOST_REQUIRE(arena.capacity() >= 6024);
+    size_t used = arena.used();
+    BOOST_REQUIRE(used >= 5083);
+
+    // the same again after a reset reuses the blocks
+    arena.reset();
+    BOOST_REQUIRE(arena.used() == 0);
+    BOOST_REQUIRE(arena.allocate_array<char>(3) == text);
+    arena.allocate_array<double>(10);
+    arena.allocate_array<char>(5000);
+    BOOST_REQUIRE(arena.num_block_allocs() == 2);
+    BOOST_REQUIRE(arena.used() == used);
+
+    for (unsigned i=0; i<1000; ++i)
+    {
+        int* vals = arena.allocate_array<int>(i % 7 + 1);
+        BOOST_REQUIRE(reinterpret_cast<uintptr_t>(vals) % alignof(int) == 0);
+        vals[i % 7] = int(i);
+    }
+    BOOST_REQUIRE(arena.allocate_array<char>(0));
+}
+
+BOOST_AUTO_TEST_CASE(test_fetch_arena_alloc_bench)
+{
+    const unsigned nrows = nbench / 10;
+    const unsigned nloops = 10;
+
+    BOOST_REQUIRE(CassConn::truncate("coll_test_data", consist));
+    PreparedStorePtr coll_store = CassConn::prepare_store(
+            "insert into coll_test_data (docid, value_list, value_set, value_map) values(?, ?, ?, ?)", 4);
+    BOOST_REQUIRE(coll_store);
+    {
+        vector<int> list = {1, 2, 4, 8, 16, 32, 64, 128};
+        set<int> set_vals(list.begin(), list.end());
+        map<int, int> map_vals;
+        for (auto it = list.begin(); it != list.end(); ++it)
+        {
+            map_vals[*it] = 2 * *it;
+        }
+        BulkWriter writer(coll_store);
+        for (unsigned docid=0; docid<nrows; ++docid)
+        {
+            BOOST_REQUIRE(writer.write(int(docid), list, set_vals, map_vals));
+        }
+        BOOST_REQUIRE(writer.flush());
+    }
+
+    BOOST_REQUIRE(CassConn::truncate("blob_data", consist));
+    PreparedStorePtr blob_store = CassConn::prepare_store("insert into blob_data (docid, value) values(?, ?)", 2);
+    BOOST_REQUIRE(blob_store);
+    {
+        const string blob(1024, 'x');
+        BulkWriter writer(blob_store);
+        for (unsigned docid=0; docid<nrows; ++docid)
+        {
+            BOOST_REQUIRE(writer.write(int(docid), as_bytes(blob)));
+        }
+        BOOST_REQUIRE(writer.flush());
+    }
+
+    const string coll_query = "select docid, value_list, value_set, value_map from coll_test_data";
+    uint64_t start = num_news.load();
+    for (unsigned i=0; i<nloops; ++i)
+    {
+        CollFetcher fetcher;
+        BOOST_REQUIRE(CassConn::fetch(coll_query, fetcher));
+        BOOST_REQUIRE(fetcher.rows.size() == nrows);
+    }
+    uint64_t coll_news = num_news.load() - start;
+
+    start = num_news.load();
+    ArenaCollFetcher arena_fetcher;
+    for (unsigned i=0; i<nloops; ++i)
+    {
+        arena_fetcher.reset();
+        BOOST_REQUIRE(CassConn::fetch(coll_query, arena_fetcher));
+        BOOST_REQUIRE(arena_fetcher.rows.size() == nrows);
+    }
+    uint64_t arena_coll_news = num_news.load() - start;
+    const ArenaCollRow& row = arena_fetcher.rows.front();
+    BOOST_REQUIRE(row.value_list.size == 8);
+    BOOST_REQUIRE(row.value_list[3] == 8);
+    BOOST_REQUIRE(row.value_set.size == 8);
+    BOOST_REQUIRE(row.value_map.size == 8);
+    BOOST_REQUIRE(row.value_map[7].first == 128 && row.value_map[7].second == 256);
+
+    const string blob_query = "select value from blob_data";
+    start = num_news.load();
+    for (unsigned i=0; i<nloops; ++i)
+    {
+        BlobsFetcher fetcher;
+        BOOST_REQUIRE(CassConn::fetch(blob_query, fetcher));
+        BOOST_REQUIRE(fetcher.blobs.size() == nrows);
+    }
+    uint64_t blob_news = num_news.load() - start;
+
+    start = num_news.load();
+    ArenaBlobsFetcher arena_blob_fetcher;
+    for (unsigned i=0; i<nloops; ++i)
+    {
+        arena_blob_fetcher.reset();
+        BOOST_REQUIRE(CassConn::fetch(blob_query, arena_blob_fetcher));
+        BOOST_REQUIRE(arena_blob_fetcher.blobs.size() == nrows);
+    }
+    uint64_t arena_blob_news = num_news.load() - start;
+    BOOST_REQUIRE(arena_blob_fetcher.blobs.front().size == 1024);
+
+    BOOST_REQUIRE(arena_coll_news < coll_news);
+    BOOST_REQUIRE(arena_blob_news < blob_news);
+
+    BOOST_MESSAGE("allocations for " << nloops << " fetches of " << nrows << " rows:"
+                    << " coll_test_data " << coll_news << " with std containers, "
+                    << arena_coll_news << " with FetchArena;"
+                    << " blob_data " << blob_news << " with CassBytesMgr, "
+                    << arena_blob_news << " with FetchArena");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
@@ -0,0 +1,79 @@
+#include <boost/program_options.hpp>
+#include <boost/test/unit_test.hpp>
+#include "cql-interface/cql-interface.h"
+#include <limits>
+
+#include "log4cxx/logger.h"
+
+using namespace log4cxx;
+using namespace log4cxx::helpers;
+
+using namespace std;
+using namespace cb::cass_util;
+using namespace cb;
+
+namespace
+{
+    static log4cxx::LoggerPtr logger(Logger::getLogger("cb.murmur3_test"));
+}
+
+
+BOOST_AUTO_TEST_SUITE( Murmur3Tests )
+
+BOOST_AUTO_TEST_CASE(test_murmur3_token)
+{
+    // same as "select token(docid) from other_test_data" on the server
+    BOOST_REQUIRE(PartitionKey::token(1) == -4069959284402364209LL);
+    BOOST_REQUIRE(PartitionKey::token(2) == -3248873570005575792LL);
+    BOOST_REQUIRE(PartitionKey::token(3) == 9010454139840013625LL);
+
+    // bigint key
+    BOOST_REQUIRE(PartitionKey::token(cass_int64_t(1)) == 6292367497774912474LL);
+
+    BOOST_REQUIRE(murmur3_token(string()) == 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_partition_key)
+{
+    BOOST_REQUIRE(PartitionKey::make(1) == string("\0\0\0\x01", 4));
+    BOOST_REQUIRE(PartitionKey::make(string("ab")) == "ab");
+
+    // composite key: 2 byte length, value, 0 for each part
+    BOOST_REQUIRE(PartitionKey::make(1, string("ab")) == string("\0\x04\0\0\0\x01\0" "\0\x02" "ab\0", 12));
+
+    RefId refid;
+    refid.randomize();
+    string key = PartitionKey::make(refid);
+    BOOST_REQUIRE(key.size() == CASS_UUID_NUM_BYTES);
+    BOOST_REQUIRE(PartitionKey::token(refid) == murmur3_token(key));
+}
+
+BOOST_AUTO_TEST_CASE(test_split_ring)
+{
+    auto ranges = TokenRangeScanner::split_ring(4);
+    BOOST_REQUIRE(ranges.size() == 4);
+    BOOST_REQUIRE(ranges.front().first == numeric_limits<int64_t>::min());
+    BOOST_REQUIRE(ranges.back().second == numeric_limits<int64_t>::max());
+    for (size_t i=1; i<ranges.size(); ++i)
+    {
+        BOOST_REQUIRE(ranges[i].first == ranges[i-1].second);
+        BOOST_REQUIRE(ranges[i].first < ranges[i].second);
+    }
+
+    // every token lands in exactly one range
+    for (int key=0; key<100; ++key)
+    {
+        int64_t token = PartitionKey::token(key);
+        unsigned found = 0;
+        for (auto it = ranges.begin(); it != ranges.end(); ++it)
+        {
+            found += (token > it->first && token <= it->second);
+        }
+        BOOST_REQUIRE(found == 1);
+    }
+
+    BOOST_REQUIRE(TokenRangeScanner::split_ring(0).size() == 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
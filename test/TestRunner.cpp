@@ -21,6 +21,9 @@ using namespace log4cxx::helpers;
 unsigned nruns = 100;
 unsigned nsize = 100;
 unsigned npost = 8;
+unsigned nbench = 10000;
+unsigned nthreads = 8;
+unsigned ncolumnar = 10000;
 string src_dir;
 
 namespace {
@@ -51,6 +54,9 @@ init_unit_test_suite( int argc, char* argv[] ) {
     desc.add_options()
       ("nruns", po::value<unsigned>(&nruns)->default_value(10), "number of runs to make")
       ("nsize", po::value<unsigned>(&nsize)->default_value(100), "number of entries per posting list")
+      ("nbench", po::value<unsigned>(&nbench)->default_value(10000), "number of operations for throughput benchmarks")
+      ("nthreads", po::value<unsigned>(&nthreads)->default_value(8), "number of threads for throughput benchmarks")
+      ("ncolumnar", po::value<unsigned>(&ncolumnar)->default_value(10000), "number of rows for the columnar decode benchmark")
       ("src_dir", 
             po::value<string>(&src_dir)->default_value("."), 
             "source directory with supporting file for tests")